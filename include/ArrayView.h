@@ -0,0 +1,59 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+// Read-only window over contiguous storage owned by someone else. The view is
+// invalidated by anything that reallocates or resizes the underlying vector.
+template <typename T>
+class ArrayView
+{
+public:
+  ArrayView()
+    : first(nullptr), count(0)
+  {
+  }
+
+  ArrayView(const T* first, std::size_t count)
+    : first(first), count(count)
+  {
+  }
+
+  ArrayView(const std::vector<T>& values)
+    : first(values.data()), count(values.size())
+  {
+  }
+
+  const T* begin() const
+  {
+    return first;
+  }
+
+  const T* end() const
+  {
+    return first + count;
+  }
+
+  const T* data() const
+  {
+    return first;
+  }
+
+  std::size_t size() const
+  {
+    return count;
+  }
+
+  bool empty() const
+  {
+    return count == 0;
+  }
+
+  const T& operator[](std::size_t index) const
+  {
+    return first[index];
+  }
+
+private:
+  const T* first;
+  std::size_t count;
+};
\ No newline at end of file
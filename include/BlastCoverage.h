@@ -0,0 +1,45 @@
+#pragma once
+#include "Vertex.h"
+#include "ArrayView.h"
+#include "OccupancyGrid.h"
+#include <vector>
+#include <utility>
+
+// A blast polygon rasterised onto the tile grid. Cells crossed by the polygon's
+// outline are marked as boundary cells and keep a list of the outline segments
+// touching them; all other cells are either fully covered or fully clear, so most
+// overlap queries are answered from the bitmasks alone. The bitmasks only span the
+// window of cells under the polygon's bounding box, so their size follows the blast's
+// reach rather than the level's.
+class BlastCoverage
+{
+public:
+  BlastCoverage();
+  void rasterise(ArrayView<Vertex>, int, int, float);
+  void clear();
+  bool overlapsBox(float, float, float, float) const;
+private:
+  static constexpr float BOUNDARY_EPSILON = 0.01f;
+  int nTilesWidth;
+  int nTilesHeight;
+  int windowColumn;
+  int windowRow;
+  int windowWidth;
+  int windowHeight;
+  float tileSize;
+  std::vector<Vertex> outline;
+  std::vector<std::pair<int, float>> rowCrossings;
+  std::vector<std::pair<int, int>> boundarySegments;
+  OccupancyGrid coveredCells;
+  OccupancyGrid boundaryCells;
+  void setWindow();
+  void markBoundarySegment(int, Vertex, Vertex);
+  void addRowCrossings(Vertex, Vertex);
+  void fillCoveredRows();
+  int clampColumn(int) const;
+  int clampRow(int) const;
+  int getCellIndex(int, int) const;
+  bool cellSegmentsIntersectBox(int, float, float, float, float) const;
+  bool segmentIntersectsBox(Vertex, Vertex, float, float, float, float) const;
+  bool isPointCovered(float, float) const;
+};
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 struct BlastRay
 {
+  // A PseudoAngle, not radians
   float angle;
   float x, y;
 };
\ No newline at end of file
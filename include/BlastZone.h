@@ -1,27 +1,62 @@
 #pragma once
 #include "Edge.h"
-#include "LineSegment.h"
+#include "ArrayView.h"
 #include "BlastRay.h"
+#include "EdgeArrays.h"
+#include "Vertex.h"
+#include "BlastZoneBackend.h"
+#include "VisibilitySweep.h"
+#include "BlastCoverage.h"
+#include "LevelChunk.h"
+#include "Corner.h"
 #include "Player.h"
 #include <vector>
 #include <array>
 #include <utility>
 
+class Level;
+
 class BlastZone
 {
 public:
-  BlastZone(float, float);
-  void drawBlastZone(float, float, const std::vector<Edge>&, float alpha=1.0f);
-  bool isPlayerInBlastZone(float, float, const Player&) const;
+  BlastZone(float, float, BlastZoneBackend backend=BlastZoneBackend::EDGE_MAP);
+  void reset(BlastZoneBackend, float);
+  BlastZoneBackend getBackend() const;
+  float getRadius() const;
+  void updateBlastZone(float, float, const Level&);
+  const std::vector<Vertex>& getTriangleFan() const;
+  bool isPlayerInBlastZone(const Player&) const;
+  bool overlapsBox(float, float, float, float) const;
 private:
-  float rayDeviance;
+  static const int CIRCLE_SEGMENTS = 64;
+  float rotationCos;
+  float rotationSin;
   float radius;
+  float clipRadius;
+  BlastZoneBackend backend;
+  int edgeMapVersion;
+  ChunkRange blastChunks;
+  std::vector<int> nearbyEdgeIDs;
+  std::vector<Edge> nearbyEdges;
+  std::vector<Corner> nearbyCorners;
+  std::vector<Vertex> clipPoints;
+  std::vector<Vertex> rayDirections;
+  std::array<Vertex, CIRCLE_SEGMENTS> circleDirections;
   std::vector<BlastRay> blastZonePolygonPoints;
-  void convertEdgeMapToBlastZone(float, float, const std::vector<Edge>&);
-  void updateBlastZonePolygonPoints(float, float, float, const std::vector<Edge>&);
-  std::pair<float, float> getIntersectionPoints(LineSegment, LineSegment) const;
-  bool isPlayerContainedInBlastZone(float, float, BlastRay, BlastRay, const Player&) const;
-  bool isPlayerIntersectsWithBlastZone(float, float, BlastRay, const std::array<Edge,4>&) const;
-  bool getWindingOrder(float, float, BlastRay, BlastRay) const;
-  void drawTriangleInCorrectOrder(float, float, BlastRay, BlastRay, float alpha) const;
+  std::vector<BlastRay> rayHits;
+  std::vector<unsigned char> rayHitFlags;
+  std::vector<Vertex> blastZoneTriangleFan;
+  VisibilitySweep visibilitySweep;
+  BlastCoverage coverage;
+  void convertEdgeMapToBlastZone(float, float, const Level&);
+  void addCornerRays(float, float);
+  bool castRay(float, float, float, float, const Level&, BlastRay&) const;
+  void collectNearbyEdges(float, float, const Level&);
+  void clipNearbyEdgesToRadius(float, float);
+  void addCircleEdges(float, float);
+  bool updateBlastZonePolygonPoints(float, float, float, float, const Level&, BlastRay&) const;
+  bool traceRayThroughTiles(float, float, float, float, const Level&, BlastRay&) const;
+  BlastRay createBlastRay(float, float, float, float) const;
+  void buildTriangleFan(float, float);
+  void rasteriseCoverage(const Level&);
 };
\ No newline at end of file
@@ -0,0 +1,6 @@
+#pragma once
+
+enum class BlastZoneBackend
+{
+  EDGE_MAP, TILE_GRID, ANGULAR_SWEEP
+};
\ No newline at end of file
@@ -1,28 +1,48 @@
 #pragma once
-#include "raylib.h"
 #include "Edge.h"
 #include "BlastZone.h"
+#include "BlastZoneBackend.h"
 #include "Player.h"
+#include "JobSystem.h"
+#include <memory>
+
+class Level;
 
 class Bomb
 {
 public:
-  Bomb(float, float, float, float);
+  static constexpr float BLAST_RADIUS = 1000.0f;
+
+  Bomb();
+  Bomb(float, float, float, float, float blastRadius=BLAST_RADIUS, BlastZoneBackend backend=BlastZoneBackend::EDGE_MAP);
+  void reset(float, float, float, float, float, BlastZoneBackend);
+  void startPrecompute(const Level&, JobSystem&);
+  void waitForPrecompute();
   float getXPosition() const;
   float getYPosition() const;
   float getBlastAlpha() const;
   float getElapsedTime() const;
-  Color getSpriteTint() const;
+  float getSpriteTintRatio() const;
+  const BlastZone& getBlastZone() const;
   bool isBlastStarted() const;
   bool isBlastOver() const;
   bool isPlayerInBlast(const Player&) const;
-  bool update(float);
-  bool draw(const std::vector<Edge>&, const Player&);
+  bool update(float, const Level&);
+  bool checkPlayerHit(const Player&);
   bool isBlastSoundPlayed() const;
   void setBlastSoundPlayed();
   bool shouldPlayBeepSound() const;
   void setLastPlayedBeepSoundTime();
 private:
+  // Lives on the heap so a job can keep writing to it while the bomb is swapped around the pool
+  struct BlastPrecompute
+  {
+    BlastPrecompute(float, float);
+    BlastZone blastZone;
+    JobSystem::JobCounter pending;
+  };
+
+  static constexpr float RAY_DEVIANCE = 0.0001f;
   float xPosition;
   float yPosition;
   float blastAlpha;
@@ -38,8 +58,10 @@ private:
   int lastPlayedBeepSoundTime;
 
   BlastZone blastZone;
+  std::unique_ptr<BlastPrecompute> precompute;
+  JobSystem* precomputeJobSystem;
 
-  void startBlast(float);
+  void startBlast(const Level&);
   void updateBlast(float);
-  bool updateCountDown(float);
+  bool updateCountDown(float, const Level&);
 };
\ No newline at end of file
@@ -1,26 +1,56 @@
 #pragma once
-#include "raylib.h"
 #include "Bomb.h"
+#include "BlastZoneBackend.h"
 #include "Player.h"
+#include "GameAudio.h"
+#include "JobSystem.h"
 #include <vector>
-#include <string>
+#include <cstddef>
+#include <cstdint>
+
+class Level;
+
+struct BombHandle
+{
+  std::uint32_t slot;
+  std::uint32_t generation;
+};
 
 class BombField
 {
 public:
+  static const std::size_t MAX_BOMBS = 1024;
+
   BombField();
   ~BombField();
-  void addBomb(Bomb*);
-  bool update(float);
-  bool drawBombs(const std::vector<Edge>&, const Player&);
+  BombHandle spawnBomb(float, float, float, float, float, BlastZoneBackend, const Level&);
+  bool isValid(BombHandle) const;
+  Bomb* getBomb(BombHandle);
+  const Bomb& getBomb(std::size_t) const;
+  std::size_t getBombCount() const;
+  void setAudio(GameAudio*);
+  void setJobSystem(JobSystem*);
+  bool update(float, const Level&);
+  bool checkPlayerHit(const Player&);
+  void waitForBlastPrecomputes();
   void clearBombField();
 private:
-  const std::string BOMB_SPRITE_PATH = "res/bomb.png";
-  const int BOMB_SPRITE_WIDTH = 16;
-  const std::string EXPLOSION_SOUND_PATH = "res/explosion.wav";
-  const std::string BEEP_SOUND_PATH = "res/beep.wav";
-  std::vector<Bomb*> bombs;
-  Texture2D bombSprite;
-  Sound explosionSound;
-  Sound beepSound;
+  struct BombSlot
+  {
+    std::uint32_t index;
+    std::uint32_t generation;
+  };
+
+  // Live bombs are packed at the front of the pool; retired ones keep their buffers for reuse
+  std::vector<Bomb> bombs;
+  std::vector<std::uint32_t> bombSlotIndices;
+  std::vector<BombSlot> slots;
+  std::vector<std::uint32_t> freeSlots;
+  std::size_t bombCount;
+  GameAudio* audio;
+  JobSystem* jobSystem;
+  std::vector<unsigned char> bombDetonations;
+  void removeBomb(std::size_t);
+  void updateBombs(float, const Level&);
+  void playBombSounds(Bomb&);
 };
\ No newline at end of file
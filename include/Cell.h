@@ -1,32 +1,21 @@
 #pragma once
-#include "raylib.h"
 #include "Direction.h"
 #include <array>
 
+// Per-cell data that is only read when editing or drawing. Whether a cell
+// exists lives in Level's OccupancyGrid, and its position follows from its index.
 class Cell
 {
 public:
-  Color color;
+  std::array<unsigned char, 4> color;
 
   Cell();
-  bool exists() const;
-  void place();
-  void remove();
   bool edgeExists(Direction) const;
-  void addEdge(Direction);
   void removeEdge(Direction);
   int getEdgeID(Direction) const;
   void setEdgeID(Direction, int);
   void clearAllEdges();
 
-  void setCoordinates(int, int);
-  int getX() const;
-  int getY() const;
-
 private:
-  bool existsFlag;
-  int x;
-  int y;
-  std::array<bool, 4> edgeExistsArray;
   std::array<int, 4> edgeIDArray;
 };
\ No newline at end of file
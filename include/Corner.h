@@ -0,0 +1,9 @@
+#pragma once
+
+// A tile corner where edges end. filledQuadrants has a bit per tile around it, in the
+// order north west, north east, south west, south east.
+struct Corner
+{
+  float x, y;
+  unsigned char filledQuadrants;
+};
\ No newline at end of file
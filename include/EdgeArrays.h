@@ -0,0 +1,42 @@
+#pragma once
+#include "Edge.h"
+#include <vector>
+#include <cstddef>
+
+struct AxisAlignedEdges
+{
+  std::vector<float> position;
+  std::vector<float> start;
+  std::vector<float> end;
+  std::vector<int> edgeIDs;
+  std::size_t count;
+};
+
+struct EdgeSlot
+{
+  bool vertical;
+  std::size_t index;
+};
+
+class EdgeArrays
+{
+public:
+  static const std::size_t LANE_PADDING = 8;
+
+  EdgeArrays();
+  void assign(const std::vector<Edge>&);
+  void addEdge(int, const Edge&);
+  void updateEdge(int, const Edge&);
+  void removeEdge(int);
+  void renameEdge(int, int);
+  const AxisAlignedEdges& getVerticalEdges() const;
+  const AxisAlignedEdges& getHorizontalEdges() const;
+private:
+  AxisAlignedEdges verticalEdges;
+  AxisAlignedEdges horizontalEdges;
+  std::vector<EdgeSlot> edgeSlots;
+  AxisAlignedEdges& getGroup(bool);
+  void clear(AxisAlignedEdges&);
+  void writeSlot(AxisAlignedEdges&, std::size_t, const Edge&);
+  void clearSlot(AxisAlignedEdges&, std::size_t);
+};
\ No newline at end of file
@@ -0,0 +1,9 @@
+#pragma once
+
+// One entry of the edge change log kept by Level for the last tile toggle.
+// { -1, id } created, { id, -1 } removed, { from, to } renamed, { id, id } resized.
+struct EdgeRemap
+{
+  int oldID;
+  int newID;
+};
\ No newline at end of file
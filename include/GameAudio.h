@@ -0,0 +1,9 @@
+#pragma once
+
+class GameAudio
+{
+public:
+  virtual ~GameAudio() = default;
+  virtual void playBeepSound() = 0;
+  virtual void playExplosionSound() = 0;
+};
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+#include "GameAudio.h"
+
+// Counts sound requests instead of playing them, so a simulation running off the
+// main thread can hand its sounds to the audio device through snapshots.
+class GameAudioCounter : public GameAudio
+{
+public:
+  GameAudioCounter();
+  void playBeepSound() override;
+  void playExplosionSound() override;
+  int getBeepCount() const;
+  int getExplosionCount() const;
+private:
+  int beepCount;
+  int explosionCount;
+};
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+#include "raylib.h"
+#include "SimulationSnapshot.h"
+#include "Vertex.h"
+#include <vector>
+#include <unordered_map>
+#include <string>
+
+class GameRenderer
+{
+public:
+  GameRenderer();
+  ~GameRenderer();
+  void updateTileLayer(const TileSnapshot&, Rectangle);
+  void drawLevel() const;
+  void drawBombs(const SimulationSnapshot&, Rectangle) const;
+  void drawPlayer(const SimulationSnapshot&, const SimulationSnapshot&, float, float alpha=1.0f) const;
+  static Vector2 getPlayerPosition(const SimulationSnapshot&, const SimulationSnapshot&, float);
+private:
+  // One chunk of the level pre-drawn into a texture. Only chunks in view keep one.
+  struct ChunkLayer
+  {
+    RenderTexture2D texture;
+    Vector2 position;
+    int generation;
+    std::size_t toggleCount;
+    bool visible;
+  };
+
+  const std::string TILE_SPRITE_PATH = "res/tiles.png";
+  const std::string BOMB_SPRITE_PATH = "res/bomb.png";
+  const std::string PLAYER_SPRITE_PATH = "res/player.png";
+  const int BOMB_SPRITE_WIDTH = 16;
+  const int PLAYER_SPRITE_WIDTH = 20;
+  const std::size_t BLAST_ZONE_BATCH_TRIANGLES = 4096;
+  Texture2D tileSprite;
+  Texture2D bombSprite;
+  Texture2D playerSprite;
+  std::unordered_map<int, ChunkLayer> chunkLayers;
+  int chunkLayerTilesWidth;
+  void updateChunkLayer(const TileSnapshot&, int, int);
+  void drawTile(const TileSnapshot&, int, Vector2) const;
+  void drawBlastZone(const std::vector<Vertex>&, float) const;
+};
\ No newline at end of file
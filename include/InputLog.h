@@ -0,0 +1,51 @@
+#pragma once
+#include "PlayerInput.h"
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+// A recorded session: the master seed, the level size and, per frame, the WASD
+// bitmask, a restart flag and the frame time fed to Simulation::step. Replaying
+// the frames against a Simulation built from the same seed reproduces the session.
+// On disk each frame takes five bytes: the mask and the frame time as a float.
+class InputLog
+{
+public:
+  struct FinalState
+  {
+    float playerX;
+    float playerY;
+    std::int32_t bombsSpawned;
+  };
+
+  InputLog();
+  InputLog(std::uint64_t, int, int, int);
+  void recordFrame(const PlayerInput&, bool, float);
+  void setFinalState(const FinalState&);
+  bool save(const std::string&) const;
+  bool load(const std::string&);
+  std::uint64_t getSeed() const;
+  int getNumberOfTilesWidth() const;
+  int getNumberOfTilesHeight() const;
+  int getTileSize() const;
+  std::size_t getFrameCount() const;
+  PlayerInput getInput(std::size_t) const;
+  bool isRestart(std::size_t) const;
+  float getFrameTime(std::size_t) const;
+  const FinalState& getFinalState() const;
+  static std::uint8_t encodeInput(const PlayerInput&);
+  static PlayerInput decodeInput(std::uint8_t);
+private:
+  static const std::uint32_t FILE_MAGIC = 0x505a4242; // "BBZP"
+  static const std::uint32_t FILE_VERSION = 1;
+  static const std::uint8_t RESTART_BIT = 16;
+
+  std::uint64_t seed;
+  int nTilesWidth;
+  int nTilesHeight;
+  int tileSize;
+  std::vector<std::uint8_t> inputMasks;
+  std::vector<float> frameTimes;
+  FinalState finalState;
+};
\ No newline at end of file
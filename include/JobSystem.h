@@ -0,0 +1,59 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+
+// A persistent pool of worker threads, each with its own task queue. Idle workers
+// steal from the front of the other queues, so uneven tasks (a blast next to a wall
+// against one in open space) still spread across every core. The thread that calls
+// parallelFor or wait works through tasks too until the work it waits on is done.
+class JobSystem
+{
+public:
+  typedef std::function<void()> Job;
+  typedef std::function<void(std::size_t, std::size_t)> RangeJob;
+  typedef std::atomic<std::size_t> JobCounter;
+
+  explicit JobSystem(int);
+  ~JobSystem();
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+  int getThreadCount() const;
+  void submit(Job, JobCounter&);
+  void wait(const JobCounter&);
+  void parallelFor(std::size_t, std::size_t, const RangeJob&);
+  static bool isInsideJob();
+private:
+  struct Task
+  {
+    Job job;
+    JobCounter* remaining;
+  };
+
+  struct WorkQueue
+  {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  // Queue 0 belongs to callers of parallelFor, the rest to one worker each
+  std::vector<std::unique_ptr<WorkQueue>> queues;
+  std::vector<std::thread> workers;
+  std::mutex wakeMutex;
+  std::condition_variable wakeCondition;
+  std::atomic<std::size_t> pendingTasks;
+  std::atomic<std::size_t> nextQueue;
+  bool stopping;
+  void workerLoop(std::size_t);
+  bool takeTask(std::size_t, Task&);
+  bool popTask(std::size_t, Task&);
+  bool stealTask(std::size_t, Task&);
+  void pushTask(std::size_t, Task);
+  static void runTask(Task&);
+};
\ No newline at end of file
@@ -2,39 +2,68 @@
 #include "Direction.h"
 #include "Cell.h"
 #include "Edge.h"
+#include "EdgeArrays.h"
+#include "EdgeRemap.h"
+#include "LevelChunk.h"
+#include "Corner.h"
+#include "OccupancyGrid.h"
+#include "ArrayView.h"
 #include "Bomb.h"
 #include "BombField.h"
+#include "BlastZoneBackend.h"
 #include "Player.h"
+#include "GameAudio.h"
+#include "JobSystem.h"
+#include "Random.h"
 #include <vector>
 #include <utility>
-#include <string>
 
 class Level
 {
 public:
-  Level(int, int, int);
-  ~Level();
+  static const int CHUNK_SIZE = 16;
+
+  Level(int, int, int, RandomStream);
+  bool cellExists(int) const;
   bool cellExistsAtCoordinate(int, int) const;
   bool coordinateHasCell(int, int) const;
-  std::vector<Cell> getTileMap() const;
+  ArrayView<Cell> getTileMap() const;
+  const OccupancyGrid& getOccupancyGrid() const;
   int getTileCount() const;
   int getTileSize() const;
   bool addTileToMap(int, int);
-  void addBombToMap(Bomb* bomb);
+  bool addBombToMap(float, float);
+  int getCellX(int) const;
+  int getCellY(int) const;
   int getCellX(int, int) const;
   int getCellY(int, int) const;
   int getNumberOfTilesWidth() const;
   int getNumberOfTilesHeight() const;
-  std::vector<Edge> getEdgeMap() const;
+  ArrayView<Edge> getEdgeMap() const;
+  int getEdgeMapVersion() const;
+  int getTileMapGeneration() const;
+  const std::vector<int>& getToggledCells() const;
+  int getChunkCountWidth() const;
+  int getChunkCountHeight() const;
+  const LevelChunk& getChunk(int, int) const;
+  ChunkRange getChunkRange(float, float, float, float) const;
+  void getEdgeIDsInChunks(const ChunkRange&, std::vector<int>&) const;
+  void getCornersInChunks(const ChunkRange&, std::vector<Corner>&) const;
+  const std::vector<EdgeRemap>& getEdgeRemaps() const;
   int getBombSpawnCount() const;
   int getBombDetonatedCount() const;
-  void drawMap();
-  bool drawBombs(const Player&);
+  const BombField& getBombField() const;
+  void setAudio(GameAudio*);
+  void setJobSystem(JobSystem*);
+  void setBlastZoneBackend(BlastZoneBackend);
+  void setBlastRadius(float);
   bool updateBombs(float, const Player&);
-  std::pair<float, float> getSpawnLocation(float) const;
+  bool checkPlayerHit(const Player&);
+  std::pair<float, float> getSpawnLocation(float);
   void generateNewLevel();
+  bool loadTileMap(const OccupancyGrid&);
+  void setCellProbability(float);
 private:
-  const std::string TILE_SPRITE_PATH = "res/tiles.png";
   const float MIN_SPAWN_PROBABILITY = 0.1f;
   const float MAX_SPAWN_PROBABILITY = 0.1f;
   const float SPAWN_PROBABILITY_UPDATE = 0.05f;
@@ -48,18 +77,34 @@ private:
   int nTilesHeight;
   int tileSize;
   int tileCount;
+  int nChunksWidth;
+  int nChunksHeight;
+  int edgeMapVersion;
+  int tileMapGeneration;
   float spawnDelay;
   float spawnProbability;
   float timeSinceLastSpawn;
+  float cellProbability;
+  float blastRadius;
+  BlastZoneBackend blastZoneBackend;
+  OccupancyGrid occupancy;
+  OccupancyGrid interiorCells;
   std::vector<Cell> tileMap;
+  std::vector<int> toggledCells;
+  std::vector<int> emptyCellIndices;
+  std::vector<int> emptyCellPositions;
   std::vector<Edge> edgeMap;
+  std::vector<Direction> edgeDirections;
+  std::vector<EdgeRemap> edgeRemaps;
+  std::vector<LevelChunk> chunks;
+  std::vector<unsigned char> cornerRefCounts;
+  std::vector<int> cornerPositions;
   BombField bombField;
-  Texture2D tileSprite;
+  RandomStream random;
   int coordinateToCellIndex(int, int) const;
   void createTileMap();
+  void resetTileMap();
   void convertTileMapToEdgeMap();
-  int getCellX(int) const;
-  int getCellY(int) const;
   int getCellRow(int) const;
   int getCellColumn(int) const;
   bool isBorderIndex(int) const;
@@ -69,9 +114,33 @@ private:
   int calculateNeighborIndex(Direction, int) const;
   void checkEdge(Direction, int);
   void addEdgeToMap(Direction, int);
+  Direction getOppositeDirection(Direction) const;
+  Direction getRunDirection(Direction) const;
+  Edge createEdgeSegment(Direction, int) const;
+  int getEdgeLength(const Edge&) const;
+  void updateEdgeSegment(Direction, int);
+  void insertEdgeSegment(Direction, int);
+  void eraseEdgeSegment(Direction, int);
+  int createEdge(const Edge&, Direction);
+  void resizeEdge(int, const Edge&);
+  void destroyEdge(int);
+  void relabelEdgeCells(const Edge&, Direction, int);
+  void rebuildChunks();
+  ChunkRange getEdgeChunkRange(const Edge&) const;
+  void addEdgeToChunks(int, const Edge&);
+  void removeEdgeFromChunks(int, const Edge&);
+  void renameEdgeInChunks(int, int, const Edge&);
+  int getCornerID(float, float) const;
+  void addCorner(int);
+  void removeCorner(int);
+  bool cellExistsAtCell(int, int) const;
   void spawnRandomBomb();
   void spawnBombNextToPlayer(const Player&);
   void updateSpawnDelay();
   void updateSpawnProbability();
-  std::vector<int> getEmptyCellIndices() const;
+  void rebuildEmptyCellIndex();
+  void updateEmptyCellIndex(int);
+  int getRandomEmptyCellIndex();
+  int getRandomInt(int);
+  float getRandomFloat();
 };
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+#include "EdgeArrays.h"
+#include <vector>
+
+// A square block of tiles and every edge that touches it. An edge that crosses a chunk
+// border is listed in each chunk it touches. Edges are keyed in edgeArrays by their
+// position in edgeIDs, so a chunk's arrays stay small however many edges the level has.
+// Edge ends are listed once in cornerIDs, in the one chunk the corner point falls in.
+struct LevelChunk
+{
+  std::vector<int> edgeIDs;
+  std::vector<int> cornerIDs;
+  EdgeArrays edgeArrays;
+};
+
+// Inclusive; empty when first > last
+struct ChunkRange
+{
+  int firstColumn;
+  int lastColumn;
+  int firstRow;
+  int lastRow;
+};
\ No newline at end of file
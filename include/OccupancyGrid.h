@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class OccupancyGrid
+{
+public:
+  static const std::size_t WORD_BITS = 64;
+
+  OccupancyGrid();
+  void resize(std::size_t);
+  void clear();
+  std::size_t getSize() const;
+  std::size_t getWordCount() const;
+  bool test(int) const;
+  void set(int);
+  void reset(int);
+  void flip(int);
+  void setRange(int, int);
+  std::uint64_t getWord(std::size_t) const;
+  std::uint64_t getBits(long long) const;
+  std::size_t count() const;
+  static int countTrailingZeros(std::uint64_t);
+  static int countBits(std::uint64_t);
+private:
+  std::size_t size;
+  std::vector<std::uint64_t> words;
+};
\ No newline at end of file
@@ -1,9 +1,8 @@
 #pragma once
-#include "raylib.h"
 #include "Direction.h"
 #include "Edge.h"
+#include "PlayerInput.h"
 #include <array>
-#include <string>
 
 class Level;
 
@@ -14,16 +13,13 @@ public:
   float getPositionX() const;
   float getPositionY() const;
   float getWidth() const;
+  Direction getSpriteDirection() const;
   void move(Direction, float, const Level&);
-  void draw() const;
-  void drawLoss(float) const;
+  void applyInput(const PlayerInput&, float, const Level&);
   void resetPlayer(float, float);
   std::array<Edge,4> getEdges() const;
 private:
-  const std::string PLAYER_SPRITE_PATH = "res/player.png";
   const int PLAYER_SPRITE_WIDTH = 20.f;
-  Color color;
-  Texture2D playerSprite;
   Direction spriteDirection;
   float velocity;
   float xPosition;
@@ -0,0 +1,6 @@
+#pragma once
+
+struct PlayerInput
+{
+  bool north, south, east, west;
+};
\ No newline at end of file
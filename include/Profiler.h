@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <cstdint>
+
+// Scope timers and counters for the hot paths, written as Chrome trace events
+// (chrome://tracing or ui.perfetto.dev). Every thread appends to its own buffer
+// without locking; a dump reads whatever each thread has published so far.
+// Build with -DBLASTZONE_PROFILING (make PROFILE=1) to enable; otherwise the macros
+// compile to nothing.
+class Profiler
+{
+public:
+  static void setThreadName(const char*);
+  static void recordScope(const char*, std::uint64_t, std::uint64_t);
+  static void recordCounter(const char*, std::int64_t);
+  static std::uint64_t now();
+  static bool writeChromeTrace(const std::string&);
+};
+
+class ProfileScope
+{
+public:
+  explicit ProfileScope(const char* name)
+    : name(name), start(Profiler::now())
+  {}
+  ~ProfileScope()
+  {
+    Profiler::recordScope(name, start, Profiler::now());
+  }
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+private:
+  const char* name;
+  std::uint64_t start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef BLASTZONE_PROFILING
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_COUNTER(name, value) Profiler::recordCounter(name, static_cast<std::int64_t>(value))
+#define PROFILE_THREAD_NAME(name) Profiler::setThreadName(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_COUNTER(name, value) ((void)0)
+#define PROFILE_THREAD_NAME(name) ((void)0)
+#endif
\ No newline at end of file
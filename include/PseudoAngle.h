@@ -0,0 +1,39 @@
+#pragma once
+#include <cmath>
+
+// A stand-in for atan2 that orders directions the same way, from -2 at -pi through 0 along
+// +x to 2 at pi, with one division instead of a transcendental call. Steps in it are not
+// proportional to angles, so it is only good for sorting and comparing directions.
+class PseudoAngle
+{
+public:
+  template <typename T>
+  static T fromDirection(T dx, T dy)
+  {
+    T fraction = dy / (std::fabs(dx) + std::fabs(dy));
+    if (dx >= 0)
+      return fraction;
+    return std::signbit(dy) ? -2 - fraction : 2 - fraction;
+  }
+
+  // The direction back out of a pseudo-angle. It is not unit length.
+  template <typename T>
+  static void toDirection(T angle, T& dx, T& dy)
+  {
+    if (angle > 1)
+    {
+      dx = 1 - angle;
+      dy = 2 - angle;
+    }
+    else if (angle < -1)
+    {
+      dx = 1 + angle;
+      dy = -2 - angle;
+    }
+    else
+    {
+      dx = 1 - std::fabs(angle);
+      dy = angle;
+    }
+  }
+};
\ No newline at end of file
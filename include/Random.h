@@ -0,0 +1,36 @@
+#pragma once
+#include <array>
+#include <string>
+#include <cstdint>
+
+// xoshiro256** generator. A stream is a plain value and is not synchronised, so
+// every thread or subsystem owns its own copy.
+class RandomStream
+{
+public:
+  RandomStream();
+  explicit RandomStream(std::uint64_t);
+  void seed(std::uint64_t);
+  std::uint64_t next();
+  int nextInt(int);
+  float nextFloat();
+  float nextSignedFloat();
+  void jump();
+private:
+  std::array<std::uint64_t, 4> state;
+  static std::uint64_t rotateLeft(std::uint64_t, int);
+};
+
+// Hands out independent named streams derived from one master seed, so a run can be
+// reproduced from that seed alone whatever order the subsystems ask for their streams.
+class RandomService
+{
+public:
+  explicit RandomService(std::uint64_t);
+  std::uint64_t getMasterSeed() const;
+  RandomStream getStream(const std::string&) const;
+  RandomStream getStream(const std::string&, int) const;
+private:
+  std::uint64_t masterSeed;
+  static std::uint64_t hashName(const std::string&);
+};
\ No newline at end of file
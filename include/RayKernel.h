@@ -0,0 +1,22 @@
+#pragma once
+#include "EdgeArrays.h"
+
+enum class RayKernelTarget
+{
+  SCALAR, SSE, AVX2
+};
+
+class RayKernel
+{
+public:
+  static float findClosestHit(const EdgeArrays&, float, float, float, float);
+  static RayKernelTarget getTarget();
+  static void setTarget(RayKernelTarget);
+  static RayKernelTarget detectTarget();
+private:
+  static RayKernelTarget target;
+  static float findClosestHit(const AxisAlignedEdges&, float, float, float, float, float);
+  static float findClosestHitScalar(const AxisAlignedEdges&, float, float, float, float, float);
+  static float findClosestHitSSE(const AxisAlignedEdges&, float, float, float, float, float);
+  static float findClosestHitAVX2(const AxisAlignedEdges&, float, float, float, float, float);
+};
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+#include "raylib.h"
+#include "GameAudio.h"
+#include <string>
+
+class RaylibAudio : public GameAudio
+{
+public:
+  RaylibAudio();
+  ~RaylibAudio();
+  void playBeepSound() override;
+  void playExplosionSound() override;
+private:
+  const std::string EXPLOSION_SOUND_PATH = "res/explosion.wav";
+  const std::string BEEP_SOUND_PATH = "res/beep.wav";
+  Sound explosionSound;
+  Sound beepSound;
+};
\ No newline at end of file
@@ -1,17 +1,20 @@
 #pragma once
 #include "raylib.h"
+#include "Random.h"
 
 class ShakyCam
 {
 public:
-  ShakyCam(Vector2, Vector2, float, float);
+  ShakyCam(Vector2, Vector2, float, float, RandomStream);
   void update(float);
   void shakeCamera();
   void resetCamera();
   void addTrauma(float=1.0f);
+  void setTarget(Vector2);
   const Camera2D& getShakyCam() const;
 private:
   Camera2D baseCam;
   Camera2D shakyCam;
   float trauma;
+  RandomStream random;
 };
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+#include "Level.h"
+#include "Player.h"
+#include "PlayerInput.h"
+#include "GameAudio.h"
+#include "JobSystem.h"
+#include "BlastZoneBackend.h"
+#include "Random.h"
+
+class Simulation
+{
+public:
+  Simulation(int, int, int, const RandomService&);
+  void step(const PlayerInput&, float);
+  void reset();
+  void setAudio(GameAudio*);
+  void setJobSystem(JobSystem*);
+  void setBlastZoneBackend(BlastZoneBackend);
+  void setBlastRadius(float);
+  bool isGameLost() const;
+  bool isBombDetonated() const;
+  int getBombsSurvived() const;
+  float getSurvivalTime() const;
+  const Level& getLevel() const;
+  const Player& getPlayer() const;
+private:
+  const float PLAYER_VELOCITY = 100.0f;
+  const int PLAYER_WIDTH = 20.f;
+  Level level;
+  Player player;
+  bool gameLost;
+  bool bombDetonated;
+  int bombsSurvived;
+  float survivalTime;
+  void startGame();
+};
\ No newline at end of file
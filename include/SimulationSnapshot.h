@@ -0,0 +1,48 @@
+#pragma once
+#include "Direction.h"
+#include "Vertex.h"
+#include "OccupancyGrid.h"
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+// Immutable once published; snapshots share it until the tiles change
+struct TileSnapshot
+{
+  int nTilesWidth;
+  int nTilesHeight;
+  int tileSize;
+  int chunkSize;
+  int generation;
+  OccupancyGrid occupancy;
+  std::vector<int> toggledCells;
+};
+
+struct BombSnapshot
+{
+  float xPosition;
+  float yPosition;
+  bool blastStarted;
+  float spriteTintRatio;
+  float blastAlpha;
+  std::vector<Vertex> triangleFan;
+};
+
+// Everything the main thread needs to draw one simulation tick. Event counts are
+// running totals, so a renderer that skips snapshots still sees every event.
+struct SimulationSnapshot
+{
+  std::uint64_t tick;
+  int gameIndex;
+  float playerX;
+  float playerY;
+  Direction playerDirection;
+  bool gameLost;
+  int bombsSurvived;
+  int bombSpawnCount;
+  int detonationCount;
+  int beepCount;
+  int explosionCount;
+  std::vector<BombSnapshot> bombs;
+  std::shared_ptr<const TileSnapshot> tiles;
+};
\ No newline at end of file
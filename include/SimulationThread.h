@@ -0,0 +1,69 @@
+#pragma once
+#include "Simulation.h"
+#include "SimulationSnapshot.h"
+#include "GameAudioCounter.h"
+#include "PlayerInput.h"
+#include "InputLog.h"
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+// Steps a Simulation at a fixed tick on its own thread and publishes a snapshot
+// after every tick. The main thread only talks to it through input, restart
+// requests and the two most recent snapshots.
+class SimulationThread
+{
+public:
+  SimulationThread(Simulation&, float);
+  ~SimulationThread();
+  void setRecording(InputLog*);
+  void setReplay(const InputLog*);
+  void start();
+  void stop();
+  void setInput(const PlayerInput&);
+  void requestRestart();
+  bool isReplayFinished() const;
+  float getSnapshots(std::shared_ptr<const SimulationSnapshot>&, std::shared_ptr<const SimulationSnapshot>&) const;
+private:
+  // Takes back snapshots once their last owner lets go, on whichever thread that is. The
+  // hand-off goes through the mutex, so the simulation never writes to a snapshot the
+  // renderer could still be reading. Shared with the deleters so it outlives the thread.
+  struct SnapshotPool
+  {
+    std::mutex mutex;
+    std::unique_ptr<SimulationSnapshot> spare;
+  };
+
+  const int MAX_CATCH_UP_TICKS = 5;
+  Simulation& simulation;
+  float tickSeconds;
+  GameAudioCounter audio;
+  InputLog* recording;
+  const InputLog* replay;
+  std::size_t replayFrame;
+  std::uint64_t tickCount;
+  int gameIndex;
+  int detonationCount;
+  std::thread thread;
+  std::atomic<bool> running;
+  std::atomic<bool> replayFinished;
+  std::atomic<bool> restartRequested;
+  std::atomic<std::uint8_t> inputMask;
+
+  mutable std::mutex snapshotMutex;
+  std::shared_ptr<const SimulationSnapshot> previousSnapshot;
+  std::shared_ptr<const SimulationSnapshot> latestSnapshot;
+  std::chrono::steady_clock::time_point latestPublishTime;
+  float latestStepSeconds;
+  std::shared_ptr<SnapshotPool> snapshotPool;
+  std::shared_ptr<const TileSnapshot> tileSnapshot;
+
+  void run();
+  float stepSimulation();
+  void publishSnapshot(float);
+  void captureTiles();
+};
\ No newline at end of file
@@ -0,0 +1,6 @@
+#pragma once
+
+struct Vertex
+{
+  float x, y;
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include "Edge.h"
+#include "ArrayView.h"
+#include "BlastRay.h"
+#include <vector>
+#include <set>
+
+class VisibilitySweep
+{
+public:
+  VisibilitySweep();
+  void computeVisibilityPolygon(float, float, ArrayView<Edge>, std::vector<BlastRay>&);
+private:
+  struct SweepSegment
+  {
+    double startX, startY;
+    double endX, endY;
+    double startAngle, endAngle;
+  };
+
+  struct SweepEvent
+  {
+    double angle;
+    bool isStart;
+    int segment;
+  };
+
+  class SegmentOrder
+  {
+  public:
+    SegmentOrder(const VisibilitySweep*);
+    bool operator()(int, int) const;
+  private:
+    const VisibilitySweep* sweep;
+  };
+
+  typedef std::set<int, SegmentOrder> ActiveSegments;
+
+  double originX, originY;
+  double sweepAngle;
+  std::vector<SweepSegment> segments;
+  std::vector<SweepEvent> events;
+  std::vector<ActiveSegments::iterator> activePositions;
+  std::vector<bool> activeFlags;
+
+  void addSegments(ArrayView<Edge>);
+  void insertSegment(ActiveSegments&, int);
+  void removeSegment(ActiveSegments&, int);
+  int getNearestSegment(const ActiveSegments&) const;
+  void addPolygonPoint(int, double, std::vector<BlastRay>&) const;
+  double getDistanceAlongRay(int, double) const;
+  bool isSegmentInFront(int, int) const;
+  int getSide(int, double, double) const;
+};
\ No newline at end of file
@@ -0,0 +1,288 @@
+#include "BlastCoverage.h"
+#include "Vertex.h"
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+BlastCoverage::BlastCoverage()
+  : nTilesWidth(0), nTilesHeight(0), windowColumn(0), windowRow(0), windowWidth(0), windowHeight(0), tileSize(1.0f)
+{
+}
+
+void BlastCoverage::rasterise(ArrayView<Vertex> polygon, int nTilesWidth, int nTilesHeight, float tileSize)
+{
+  this->nTilesWidth = nTilesWidth;
+  this->nTilesHeight = nTilesHeight;
+  this->tileSize = tileSize;
+
+  outline.assign(polygon.begin(), polygon.end());
+  if (outline.size() < 3)
+  {
+    outline.clear();
+    return;
+  }
+
+  setWindow();
+  std::size_t cellCount = static_cast<std::size_t>(windowWidth) * windowHeight;
+  coveredCells.resize(cellCount);
+  boundaryCells.resize(cellCount);
+
+  rowCrossings.clear();
+  boundarySegments.clear();
+  for (std::size_t i = 0; i < outline.size(); i++)
+  {
+    Vertex start = outline[i];
+    Vertex end = outline[(i + 1) % outline.size()];
+    markBoundarySegment(i, start, end);
+    addRowCrossings(start, end);
+  }
+  std::sort(boundarySegments.begin(), boundarySegments.end());
+  fillCoveredRows();
+}
+
+void BlastCoverage::clear()
+{
+  outline.clear();
+  coveredCells.clear();
+  boundaryCells.clear();
+}
+
+bool BlastCoverage::overlapsBox(float minX, float minY, float maxX, float maxY) const
+{
+  if (outline.empty())
+    return false;
+
+  // Clamped to the level as for the whole grid, then to the window, outside which nothing is covered
+  int firstColumn = std::max(std::max(static_cast<int>(std::floor(minX / tileSize)), 0), windowColumn);
+  int lastColumn = std::min(std::min(static_cast<int>(std::floor(maxX / tileSize)), nTilesWidth - 1), windowColumn + windowWidth - 1);
+  int firstRow = std::max(std::max(static_cast<int>(std::floor(minY / tileSize)), 0), windowRow);
+  int lastRow = std::min(std::min(static_cast<int>(std::floor(maxY / tileSize)), nTilesHeight - 1), windowRow + windowHeight - 1);
+  if (firstColumn > lastColumn || firstRow > lastRow)
+    return false;
+
+  bool boundaryTouched = false;
+  for (int row = firstRow; row <= lastRow; row++)
+  {
+    for (int column = firstColumn; column <= lastColumn; column++)
+    {
+      int cellIndex = getCellIndex(column, row);
+      if (boundaryCells.test(cellIndex))
+        boundaryTouched = true;
+      else if (coveredCells.test(cellIndex))
+        return true;
+    }
+  }
+
+  if (!boundaryTouched)
+    return false;
+
+  for (int row = firstRow; row <= lastRow; row++)
+  {
+    for (int column = firstColumn; column <= lastColumn; column++)
+    {
+      int cellIndex = getCellIndex(column, row);
+      if (boundaryCells.test(cellIndex) && cellSegmentsIntersectBox(cellIndex, minX, minY, maxX, maxY))
+        return true;
+    }
+  }
+
+  // No outline segment enters the box, so it is either wholly inside or wholly outside
+  return isPointCovered((minX + maxX) / 2, (minY + maxY) / 2);
+}
+
+// The cells under the outline's bounding box, widened by BOUNDARY_EPSILON the way
+// boundary cells are marked, and clamped to the level
+void BlastCoverage::setWindow()
+{
+  float minX = outline[0].x, maxX = outline[0].x;
+  float minY = outline[0].y, maxY = outline[0].y;
+  for (const Vertex& vertex : outline)
+  {
+    minX = std::min(minX, vertex.x);
+    maxX = std::max(maxX, vertex.x);
+    minY = std::min(minY, vertex.y);
+    maxY = std::max(maxY, vertex.y);
+  }
+
+  int firstColumn = std::min(std::max(static_cast<int>(std::floor((minX - BOUNDARY_EPSILON) / tileSize)), 0), nTilesWidth - 1);
+  int lastColumn = std::min(std::max(static_cast<int>(std::floor((maxX + BOUNDARY_EPSILON) / tileSize)), 0), nTilesWidth - 1);
+  int firstRow = std::min(std::max(static_cast<int>(std::floor((minY - BOUNDARY_EPSILON) / tileSize)), 0), nTilesHeight - 1);
+  int lastRow = std::min(std::max(static_cast<int>(std::floor((maxY + BOUNDARY_EPSILON) / tileSize)), 0), nTilesHeight - 1);
+  windowColumn = firstColumn;
+  windowRow = firstRow;
+  windowWidth = lastColumn - firstColumn + 1;
+  windowHeight = lastRow - firstRow + 1;
+}
+
+// Marks every cell the segment passes through or within BOUNDARY_EPSILON of, one row
+// strip at a time, so outlines running exactly along grid lines mark both sides.
+void BlastCoverage::markBoundarySegment(int segment, Vertex start, Vertex end)
+{
+  if (start.y > end.y)
+    std::swap(start, end);
+
+  int firstRow = clampRow(static_cast<int>(std::floor((start.y - BOUNDARY_EPSILON) / tileSize)));
+  int lastRow = clampRow(static_cast<int>(std::floor((end.y + BOUNDARY_EPSILON) / tileSize)));
+  float dy = end.y - start.y;
+
+  for (int row = firstRow; row <= lastRow; row++)
+  {
+    float top = std::max(start.y, row * tileSize - BOUNDARY_EPSILON);
+    float bottom = std::min(end.y, (row + 1) * tileSize + BOUNDARY_EPSILON);
+    if (top > bottom)
+      continue;
+
+    float topX = start.x, bottomX = end.x;
+    if (dy > 0.0f)
+    {
+      topX = start.x + (end.x - start.x) * (top - start.y) / dy;
+      bottomX = start.x + (end.x - start.x) * (bottom - start.y) / dy;
+    }
+
+    int firstColumn = clampColumn(static_cast<int>(std::floor((std::min(topX, bottomX) - BOUNDARY_EPSILON) / tileSize)));
+    int lastColumn = clampColumn(static_cast<int>(std::floor((std::max(topX, bottomX) + BOUNDARY_EPSILON) / tileSize)));
+    boundaryCells.setRange(getCellIndex(firstColumn, row), getCellIndex(lastColumn, row));
+    for (int column = firstColumn; column <= lastColumn; column++)
+      boundarySegments.push_back({ getCellIndex(column, row), segment });
+  }
+}
+
+// Records where the segment crosses the horizontal line through each row's cell centres.
+// The half-open range keeps a vertex shared by two segments from being counted twice.
+void BlastCoverage::addRowCrossings(Vertex start, Vertex end)
+{
+  if (start.y == end.y)
+    return;
+
+  float low = std::min(start.y, end.y);
+  float high = std::max(start.y, end.y);
+  int firstRow = std::max(windowRow, static_cast<int>(std::ceil(low / tileSize - 0.5f)));
+  int lastRow = std::min(windowRow + windowHeight - 1, static_cast<int>(std::ceil(high / tileSize - 0.5f)) - 1);
+
+  for (int row = firstRow; row <= lastRow; row++)
+  {
+    float centreY = (row + 0.5f) * tileSize;
+    float x = start.x + (end.x - start.x) * (centreY - start.y) / (end.y - start.y);
+    rowCrossings.push_back({ row, x });
+  }
+}
+
+// Cells the outline never touches are entirely inside or outside, so their centre decides.
+void BlastCoverage::fillCoveredRows()
+{
+  std::sort(rowCrossings.begin(), rowCrossings.end());
+
+  std::size_t rowStart = 0;
+  while (rowStart < rowCrossings.size())
+  {
+    int row = rowCrossings[rowStart].first;
+    std::size_t rowEnd = rowStart;
+    while (rowEnd < rowCrossings.size() && rowCrossings[rowEnd].first == row)
+      rowEnd++;
+
+    for (std::size_t i = rowStart; i + 1 < rowEnd; i += 2)
+    {
+      int firstColumn = std::max(windowColumn, static_cast<int>(std::ceil(rowCrossings[i].second / tileSize - 0.5f)));
+      int lastColumn = std::min(windowColumn + windowWidth - 1, static_cast<int>(std::ceil(rowCrossings[i + 1].second / tileSize - 0.5f)) - 1);
+      if (firstColumn <= lastColumn)
+        coveredCells.setRange(getCellIndex(firstColumn, row), getCellIndex(lastColumn, row));
+    }
+    rowStart = rowEnd;
+  }
+}
+
+// The window lies inside the level and holds the whole outline, so clamping to it
+// files the outline's cells exactly as clamping to the level would
+int BlastCoverage::clampColumn(int column) const
+{
+  return std::min(std::max(column, windowColumn), windowColumn + windowWidth - 1);
+}
+
+int BlastCoverage::clampRow(int row) const
+{
+  return std::min(std::max(row, windowRow), windowRow + windowHeight - 1);
+}
+
+int BlastCoverage::getCellIndex(int column, int row) const
+{
+  return (row - windowRow) * windowWidth + (column - windowColumn);
+}
+
+bool BlastCoverage::cellSegmentsIntersectBox(int cellIndex, float minX, float minY, float maxX, float maxY) const
+{
+  auto first = std::lower_bound(boundarySegments.begin(), boundarySegments.end(), std::make_pair(cellIndex, 0));
+  for (auto it = first; it != boundarySegments.end() && it->first == cellIndex; it++)
+  {
+    Vertex start = outline[it->second];
+    Vertex end = outline[(it->second + 1) % outline.size()];
+    if (segmentIntersectsBox(start, end, minX, minY, maxX, maxY))
+      return true;
+  }
+  return false;
+}
+
+bool BlastCoverage::segmentIntersectsBox(Vertex start, Vertex end, float minX, float minY, float maxX, float maxY) const
+{
+  // Liang-Barsky clip of the segment against the box
+  float dx = end.x - start.x;
+  float dy = end.y - start.y;
+  float p[4] = { -dx, dx, -dy, dy };
+  float q[4] = { start.x - minX, maxX - start.x, start.y - minY, maxY - start.y };
+  float tEnter = 0.0f, tExit = 1.0f;
+
+  for (int i = 0; i < 4; i++)
+  {
+    if (p[i] == 0.0f)
+    {
+      if (q[i] < 0.0f)
+        return false;
+    }
+    else
+    {
+      float t = q[i] / p[i];
+      if (p[i] < 0.0f)
+        tEnter = std::max(tEnter, t);
+      else
+        tExit = std::min(tExit, t);
+      if (tEnter > tExit)
+        return false;
+    }
+  }
+  return true;
+}
+
+// Even-odd test along a ray to the right of the point. Every segment the ray crosses
+// is listed by the boundary cell holding the crossing, so only that row's boundary
+// cells are visited and each crossing is counted once.
+bool BlastCoverage::isPointCovered(float x, float y) const
+{
+  int pointColumn = std::min(std::max(static_cast<int>(std::floor(x / tileSize)), 0), nTilesWidth - 1);
+  int row = std::min(std::max(static_cast<int>(std::floor(y / tileSize)), 0), nTilesHeight - 1);
+  if (pointColumn < windowColumn || pointColumn >= windowColumn + windowWidth || row < windowRow || row >= windowRow + windowHeight)
+    return false;
+  int cellIndex = getCellIndex(pointColumn, row);
+  if (!boundaryCells.test(cellIndex))
+    return coveredCells.test(cellIndex);
+
+  bool inside = false;
+  for (int column = pointColumn; column < windowColumn + windowWidth; column++)
+  {
+    int rowCellIndex = getCellIndex(column, row);
+    if (!boundaryCells.test(rowCellIndex))
+      continue;
+
+    auto first = std::lower_bound(boundarySegments.begin(), boundarySegments.end(), std::make_pair(rowCellIndex, 0));
+    for (auto it = first; it != boundarySegments.end() && it->first == rowCellIndex; it++)
+    {
+      const Vertex& start = outline[it->second];
+      const Vertex& end = outline[(it->second + 1) % outline.size()];
+      if ((start.y > y) == (end.y > y))
+        continue;
+      float crossingX = start.x + (end.x - start.x) * (y - start.y) / (end.y - start.y);
+      if (crossingX > x && clampColumn(static_cast<int>(std::floor(crossingX / tileSize))) == column)
+        inside = !inside;
+    }
+  }
+  return inside;
+}
\ No newline at end of file
@@ -1,105 +1,130 @@
-#include "raylib.h"
 #include "BlastZone.h"
 #include "Edge.h"
 #include "BlastRay.h"
-#include "LineSegment.h"
+#include "EdgeArrays.h"
+#include "RayKernel.h"
+#include "Level.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "PseudoAngle.h"
 #include <vector>
 #include <algorithm>
 #include <cmath>
 #include <iterator>
 #include <utility>
-#include <tuple>
 
-BlastZone::BlastZone(float rayDeviance, float radius)
-  : rayDeviance(rayDeviance), radius(radius)
-{}
-
-void BlastZone::drawBlastZone(float originX, float originY, const std::vector<Edge>& edgeMap, float alpha)
+// The only trigonometry a zone needs is worked out once here. Rays are aimed along
+// direction vectors, turned by rayDeviance with this rotation and sorted by pseudo-angle.
+BlastZone::BlastZone(float rayDeviance, float radius, BlastZoneBackend backend)
+  : rotationCos(std::cos(rayDeviance)), rotationSin(std::sin(rayDeviance)),
+    backend(backend), edgeMapVersion(-1)
 {
-  convertEdgeMapToBlastZone(originX, originY, edgeMap);
-  if (blastZonePolygonPoints.size() > 1)
+  for (int i = 0; i < CIRCLE_SEGMENTS; i++)
   {
-    # pragma omp parallel for
-    for (std::size_t i = 0; i < blastZonePolygonPoints.size(); i++)
-    {
-      drawTriangleInCorrectOrder(
-        originX,
-        originY,
-        blastZonePolygonPoints[i % blastZonePolygonPoints.size()],
-        blastZonePolygonPoints[(i+1) % blastZonePolygonPoints.size()],
-        alpha
-      );
-    }
+    float angle = 2.0f * static_cast<float>(M_PI) * i / CIRCLE_SEGMENTS;
+    circleDirections[i] = { std::cos(angle), std::sin(angle) };
   }
+  reset(backend, radius);
 }
 
-bool BlastZone::isPlayerInBlastZone(float originX, float originY, const Player& player) const
+void BlastZone::reset(BlastZoneBackend backend, float radius)
 {
-  std::array<Edge,4> playerEdges = player.getEdges();
-  bool playerHit = false;
-  if (blastZonePolygonPoints.size() > 1)
-  {
-    #pragma omp parallel for shared(playerHit)
-    for (std::size_t i = 0; i < blastZonePolygonPoints.size(); i++)
-    {
-      if (!playerHit)
-      {
-        if (isPlayerContainedInBlastZone(originX, originY, blastZonePolygonPoints[i % blastZonePolygonPoints.size()], blastZonePolygonPoints[(i+1) % blastZonePolygonPoints.size()], player))
-          playerHit = true;
-        if (isPlayerIntersectsWithBlastZone(originX, originY, blastZonePolygonPoints[i % blastZonePolygonPoints.size()], playerEdges))
-          playerHit = true;
-      }
-    }
-  }
-  return playerHit;
+  // Clearing keeps the buffers' capacity for the next bomb that uses this zone
+  this->backend = backend;
+  this->radius = radius;
+  // The circle inside the ring polygon, where the edges are cut
+  clipRadius = radius * std::cos(static_cast<float>(M_PI) / CIRCLE_SEGMENTS);
+  edgeMapVersion = -1;
+  blastZonePolygonPoints.clear();
+  blastZoneTriangleFan.clear();
+  coverage.clear();
+}
+
+BlastZoneBackend BlastZone::getBackend() const
+{
+  return backend;
 }
 
-bool BlastZone::isPlayerContainedInBlastZone(float originX, float originY, BlastRay ray1, BlastRay ray2, const Player& player) const
+float BlastZone::getRadius() const
 {
-  return CheckCollisionPointTriangle(
-    { player.getPositionX(), player.getPositionY() },
-    { originX, originY },
-    { ray1.x, ray1.y },
-    { ray2.x, ray2.y }
-  );
+  return radius;
 }
 
-bool BlastZone::isPlayerIntersectsWithBlastZone(float originX, float originY, BlastRay ray, const std::array<Edge,4>& playerEdges) const
+void BlastZone::updateBlastZone(float originX, float originY, const Level& level)
 {
-  LineSegment rayLineSegment = { originX, originY, ray.x - originX, ray.y - originY };
-  for (auto& edge : playerEdges)
+  if (edgeMapVersion == level.getEdgeMapVersion())
+    return;
+  PROFILE_SCOPE("BlastZone::updateBlastZone");
+  collectNearbyEdges(originX, originY, level);
+  clipNearbyEdgesToRadius(originX, originY);
+  if (backend == BlastZoneBackend::ANGULAR_SWEEP)
   {
-    LineSegment playerEdgeLineSegment = { edge.startX, edge.startY, edge.endX - edge.startX, edge.endY - edge.startY };
-    if (std::fabs(playerEdgeLineSegment.dx - rayLineSegment.dx) > 0.0f && std::fabs(playerEdgeLineSegment.dy - rayLineSegment.dy) > 0.0f)
-    {
-      float t1, t2;
-      std::tie(t1, t2) = getIntersectionPoints(rayLineSegment, playerEdgeLineSegment);
-      if (t1 >= 0 && t1 <= 1 && t2 >= 0 && t2 <= 1)
-        return true;
-    }
+    addCircleEdges(originX, originY);
+    visibilitySweep.computeVisibilityPolygon(originX, originY, nearbyEdges, blastZonePolygonPoints);
+  }
+  else
+  {
+    convertEdgeMapToBlastZone(originX, originY, level);
   }
-  return false;
+  buildTriangleFan(originX, originY);
+  {
+    PROFILE_SCOPE("BlastZone::rasteriseCoverage");
+    rasteriseCoverage(level);
+  }
+  edgeMapVersion = level.getEdgeMapVersion();
 }
 
-void BlastZone::convertEdgeMapToBlastZone(float originX, float originY, const std::vector<Edge>& edgeMap)
+const std::vector<Vertex>& BlastZone::getTriangleFan() const
 {
-  blastZonePolygonPoints.clear();
+  return blastZoneTriangleFan;
+}
 
-  #pragma omp parallel for
-  for (std::size_t i = 0; i < edgeMap.size(); i++)
-  {
-    Edge e = edgeMap[i];
-    for (int j = 0; j < 2; j++) // Loop for start and end point of each edge
-    {
-      float ray_dx = (j == 0 ? e.startX : e.endX) - originX;
-      float ray_dy = (j == 0 ? e.startY : e.endY) - originY;
-      float baseAngle = std::atan2(ray_dy, ray_dx);
+bool BlastZone::isPlayerInBlastZone(const Player& player) const
+{
+  PROFILE_SCOPE("BlastZone::isPlayerInBlastZone");
+  float playerX = player.getPositionX();
+  float playerY = player.getPositionY();
+  return overlapsBox(playerX, playerY, playerX + player.getWidth(), playerY + player.getWidth());
+}
 
-      updateBlastZonePolygonPoints(originX, originY, baseAngle - rayDeviance, edgeMap);
-      updateBlastZonePolygonPoints(originX, originY, baseAngle, edgeMap);
-      updateBlastZonePolygonPoints(originX, originY, baseAngle + rayDeviance, edgeMap);
-    }
+bool BlastZone::overlapsBox(float minX, float minY, float maxX, float maxY) const
+{
+  return coverage.overlapsBox(minX, minY, maxX, maxY);
+}
+
+void BlastZone::convertEdgeMapToBlastZone(float originX, float originY, const Level& level)
+{
+  PROFILE_SCOPE("BlastZone::convertEdgeMapToBlastZone");
+  rayDirections.clear();
+  addCornerRays(originX, originY);
+
+  // Where an edge was cut short at the radius the polygon turns from the edge onto the circle
+  for (const Vertex& point : clipPoints)
+    rayDirections.push_back({ point.x - originX, point.y - originY });
+
+  // Rays that reach the radius end on the circle, so a ring of rays keeps open
+  // stretches of the polygon round instead of cutting straight across them
+  rayDirections.insert(rayDirections.end(), circleDirections.begin(), circleDirections.end());
+
+  // Every ray owns a fixed slot, so threads never share a write target and the
+  // buffers keep their capacity between blasts. When bombs already run as jobs the
+  // cores are busy with other bombs, so the rays stay on the job's thread.
+  std::size_t rayCount = rayDirections.size();
+  PROFILE_COUNTER("rays cast", rayCount);
+  rayHits.resize(rayCount);
+  rayHitFlags.resize(rayCount);
+
+  #pragma omp parallel for if(!JobSystem::isInsideJob())
+  for (std::size_t i = 0; i < rayCount; i++)
+    rayHitFlags[i] = castRay(originX, originY, rayDirections[i].x, rayDirections[i].y, level, rayHits[i]);
+
+  blastZonePolygonPoints.clear();
+  for (std::size_t i = 0; i < rayCount; i++)
+  {
+    if (rayHitFlags[i])
+      blastZonePolygonPoints.push_back(rayHits[i]);
   }
+
   std::sort(
     blastZonePolygonPoints.begin(), blastZonePolygonPoints.end(),
     [](const BlastRay& r1, const BlastRay& r2)
@@ -118,91 +143,219 @@ void BlastZone::convertEdgeMapToBlastZone(float originX, float originY, const st
   blastZonePolygonPoints.resize(std::distance(blastZonePolygonPoints.begin(), uniquePointIterator));
 }
 
-void BlastZone::updateBlastZonePolygonPoints(float ray_startX, float ray_startY, float angle, const std::vector<Edge>& edgeMap)
+// No ray is longer than the radius, so only edges in the chunks within it can be hit.
+// This keeps the cost of a blast independent of the size of the level.
+void BlastZone::collectNearbyEdges(float originX, float originY, const Level& level)
 {
-  float ray_dx = radius * std::cos(angle);
-  float ray_dy = radius * std::sin(angle);
+  blastChunks = level.getChunkRange(originX - radius, originY - radius, originX + radius, originY + radius);
+  level.getEdgeIDsInChunks(blastChunks, nearbyEdgeIDs);
+  level.getCornersInChunks(blastChunks, nearbyCorners);
+  ArrayView<Edge> edgeMap = level.getEdgeMap();
+  nearbyEdges.clear();
+  for (int edgeID : nearbyEdgeIDs)
+    nearbyEdges.push_back(edgeMap[edgeID]);
+}
 
-  float min_t1 = INFINITY;
-  float pxAtClosest = 0, pyAtClosest = 0, angleAtClosest = 0;
-  bool intersectionOccurs = false;
+// Each corner within reach gets one ray, and the two rays either side of it only when
+// the corner can cast a shadow edge. That needs exactly one of the two edges meeting
+// there to face the blast, which the filled tiles around the corner tell apart without
+// looking at the edges. A corner inside another tile's shadow still casts its rays,
+// which end on whatever hides it.
+void BlastZone::addCornerRays(float originX, float originY)
+{
+  for (const Corner& corner : nearbyCorners)
+  {
+    float ray_dx = corner.x - originX;
+    float ray_dy = corner.y - originY;
+    float distanceSquared = ray_dx * ray_dx + ray_dy * ray_dy;
+    if (distanceSquared == 0.0f || distanceSquared > clipRadius * clipRadius)
+      continue;
 
-  for (const auto& edge : edgeMap)
+    // Quadrant of the tile the blast sees the corner from, in filledQuadrants' bit order
+    int originQuadrant = (ray_dx < 0 ? 1 : 0) | (ray_dy < 0 ? 2 : 0);
+    bool onEdgeLine = ray_dx == 0.0f || ray_dy == 0.0f;
+    bool isOuterCorner = corner.filledQuadrants == 1 || corner.filledQuadrants == 2
+      || corner.filledQuadrants == 4 || corner.filledQuadrants == 8;
+    bool isInnerCorner = corner.filledQuadrants == 7 || corner.filledQuadrants == 11
+      || corner.filledQuadrants == 13 || corner.filledQuadrants == 14;
+
+    // An outer corner seen from behind its own tile is hidden by it
+    if (isOuterCorner && !onEdgeLine && corner.filledQuadrants == 1 << originQuadrant)
+      continue;
+
+    rayDirections.push_back({ ray_dx, ray_dy });
+    bool facesBothEdges = isOuterCorner && !onEdgeLine && corner.filledQuadrants == 1 << (originQuadrant ^ 3);
+    if (isInnerCorner || facesBothEdges)
+      continue;
+    rayDirections.push_back({ ray_dx * rotationCos + ray_dy * rotationSin, ray_dy * rotationCos - ray_dx * rotationSin });
+    rayDirections.push_back({ ray_dx * rotationCos - ray_dy * rotationSin, ray_dy * rotationCos + ray_dx * rotationSin });
+  }
+}
+
+// The chunks cover a square around the blast. Drop the edges in its corners that the
+// blast does not reach and cut the rest short, so no rays are aimed past the radius. The
+// cut is at the circle inside the ring polygon, so clipped edges never cross the ring.
+void BlastZone::clipNearbyEdgesToRadius(float originX, float originY)
+{
+  clipPoints.clear();
+  std::size_t keptEdges = 0;
+  for (const Edge& edge : nearbyEdges)
   {
-    float edge_dx = edge.endX - edge.startX;
-    float edge_dy = edge.endY - edge.startY;
+    float dx = edge.endX - edge.startX;
+    float dy = edge.endY - edge.startY;
+    float fx = edge.startX - originX;
+    float fy = edge.startY - originY;
+    float a = dx * dx + dy * dy;
+    float b = fx * dx + fy * dy;
+    float c = fx * fx + fy * fy - clipRadius * clipRadius;
+    float discriminant = b * b - a * c;
+    if (a == 0.0f || discriminant <= 0.0f)
+      continue;
 
-    if (std::fabs(edge_dx - ray_dx) > 0.0f && std::fabs(edge_dy - ray_dy) > 0.0f)
-    {
-      LineSegment edgeLineSegment = { edge.startX, edge.startY, edge_dx, edge_dy };
-      LineSegment rayLineSegment = { ray_startX, ray_startY, ray_dx, ray_dy };
-      float t1, t2;
-      std::tie(t1, t2) = getIntersectionPoints(rayLineSegment, edgeLineSegment);
-
-      if (t1 >= 0 && t2 >= 0 && t2 <= 1)
-      {
-        if (t1 < min_t1)
-        {
-          min_t1 = t1;
-          pxAtClosest = ray_startX + ray_dx * t1;
-          pyAtClosest = ray_startY + ray_dy * t1;
-          angleAtClosest = std::atan2(pyAtClosest - ray_startY, pxAtClosest - ray_startX);
-          intersectionOccurs = true;
-        }
-      }
-    }
+    float root = std::sqrt(discriminant);
+    float s0 = std::max((-b - root) / a, 0.0f);
+    float s1 = std::min((-b + root) / a, 1.0f);
+    if (s0 >= s1)
+      continue;
+    if (s0 > 0.0f)
+      clipPoints.push_back({ edge.startX + dx * s0, edge.startY + dy * s0 });
+    if (s1 < 1.0f)
+      clipPoints.push_back({ edge.startX + dx * s1, edge.startY + dy * s1 });
+    nearbyEdges[keptEdges++] = { edge.startX + dx * s0, edge.startY + dy * s0, edge.startX + dx * s1, edge.startY + dy * s1 };
   }
+  nearbyEdges.resize(keptEdges);
+}
 
-  if (intersectionOccurs)
+// The sweep needs a closed boundary in every direction, which a slice of a large level
+// does not have. Close it with the same polygon the other backends' ring rays trace.
+void BlastZone::addCircleEdges(float originX, float originY)
+{
+  float previousX = originX + radius * circleDirections[0].x;
+  float previousY = originY + radius * circleDirections[0].y;
+  for (int i = 1; i <= CIRCLE_SEGMENTS; i++)
   {
-    #pragma omp critical(addRayToBlastZone)
-    {
-      blastZonePolygonPoints.push_back({ angleAtClosest, pxAtClosest, pyAtClosest });
-    }
+    float x = originX + radius * circleDirections[i % CIRCLE_SEGMENTS].x;
+    float y = originY + radius * circleDirections[i % CIRCLE_SEGMENTS].y;
+    nearbyEdges.push_back({ previousX, previousY, x, y });
+    previousX = x;
+    previousY = y;
   }
 }
 
-std::pair<float, float> BlastZone::getIntersectionPoints(LineSegment l1, LineSegment l2) const
+bool BlastZone::castRay(float ray_startX, float ray_startY, float directionX, float directionY, const Level& level, BlastRay& hit) const
 {
-  float t1 = (l2.dx * (l1.startY - l2.startY) - l2.dy * (l1.startX - l2.startX)) / (l1.dx * l2.dy - l1.dy * l2.dx);
-  float t2 = (l1.dx * (l1.startY - l2.startY) - l1.dy * (l1.startX - l2.startX)) / (l1.dx * l2.dy - l1.dy * l2.dx);
-  return std::make_pair(t1, t2);
+  switch (backend)
+  {
+    case BlastZoneBackend::EDGE_MAP:
+      return updateBlastZonePolygonPoints(ray_startX, ray_startY, directionX, directionY, level, hit);
+    case BlastZoneBackend::TILE_GRID:
+      return traceRayThroughTiles(ray_startX, ray_startY, directionX, directionY, level, hit);
+    default:
+      return false;
+  }
 }
 
-bool BlastZone::getWindingOrder(float originX, float originY, BlastRay ray1, BlastRay ray2) const
+bool BlastZone::updateBlastZonePolygonPoints(float ray_startX, float ray_startY, float directionX, float directionY, const Level& level, BlastRay& hit) const
 {
-  float vector1_x = ray1.x - originX;
-  float vector1_y = ray1.y - originY;
-  float vector2_x = ray2.x - originX;
-  float vector2_y = ray2.y - originY;
-  float crossProduct = vector1_x * vector2_y - vector2_x * vector1_y;
-  return crossProduct > 0;
+  // Scaled to the radius, so a hit past t1 = 1 is out of reach
+  float scale = radius / std::sqrt(directionX * directionX + directionY * directionY);
+  float ray_dx = directionX * scale;
+  float ray_dy = directionY * scale;
+
+  float min_t1 = INFINITY;
+  for (int row = blastChunks.firstRow; row <= blastChunks.lastRow; row++)
+  {
+    for (int column = blastChunks.firstColumn; column <= blastChunks.lastColumn; column++)
+      min_t1 = std::min(min_t1, RayKernel::findClosestHit(level.getChunk(column, row).edgeArrays, ray_startX, ray_startY, ray_dx, ray_dy));
+  }
+  min_t1 = std::min(min_t1, 1.0f);
+  hit = createBlastRay(ray_dx, ray_dy, ray_startX + ray_dx * min_t1, ray_startY + ray_dy * min_t1);
+  return true;
 }
 
-void BlastZone::drawTriangleInCorrectOrder(float originX, float originY, BlastRay ray1, BlastRay ray2, float alpha) const
+bool BlastZone::traceRayThroughTiles(float ray_startX, float ray_startY, float directionX, float directionY, const Level& level, BlastRay& hit) const
 {
-  if (!getWindingOrder(originX, originY, ray1, ray2))
+  // Unit length, so t is the distance travelled
+  float length = std::sqrt(directionX * directionX + directionY * directionY);
+  float ray_dx = directionX / length;
+  float ray_dy = directionY / length;
+  float tileSize = static_cast<float>(level.getTileSize());
+
+  int cellColumn = static_cast<int>(std::floor(ray_startX / tileSize));
+  int cellRow = static_cast<int>(std::floor(ray_startY / tileSize));
+  int stepColumn = ray_dx > 0 ? 1 : -1;
+  int stepRow = ray_dy > 0 ? 1 : -1;
+
+  float t_maxX = INFINITY, t_maxY = INFINITY;
+  float t_deltaX = INFINITY, t_deltaY = INFINITY;
+  if (ray_dx != 0.0f)
   {
-    #pragma omp critical(drawTriangle)
-    {
-      DrawTriangle(
-        {originX, originY}, 
-        {ray1.x, ray1.y},
-        {ray2.x, ray2.y},
-        Fade(RAYWHITE, alpha)
-      );
-    }
+    float nextBoundaryX = (cellColumn + (ray_dx > 0 ? 1 : 0)) * tileSize;
+    t_maxX = (nextBoundaryX - ray_startX) / ray_dx;
+    t_deltaX = tileSize / std::fabs(ray_dx);
   }
-  else
+  if (ray_dy != 0.0f)
+  {
+    float nextBoundaryY = (cellRow + (ray_dy > 0 ? 1 : 0)) * tileSize;
+    t_maxY = (nextBoundaryY - ray_startY) / ray_dy;
+    t_deltaY = tileSize / std::fabs(ray_dy);
+  }
+
+  float t = 0.0f;
+  while (t <= radius)
   {
-    #pragma omp critical(drawTriangle)
+    if (cellColumn < 0 || cellColumn >= level.getNumberOfTilesWidth() || cellRow < 0 || cellRow >= level.getNumberOfTilesHeight())
+      return false;
+    if (level.cellExists(cellRow * level.getNumberOfTilesWidth() + cellColumn))
+    {
+      hit = createBlastRay(ray_dx, ray_dy, ray_startX + ray_dx * t, ray_startY + ray_dy * t);
+      return true;
+    }
+
+    if (t_maxX < t_maxY)
+    {
+      t = t_maxX;
+      t_maxX += t_deltaX;
+      cellColumn += stepColumn;
+    }
+    else
     {
-      DrawTriangle(
-        {originX, originY}, 
-        {ray2.x, ray2.y},
-        {ray1.x, ray1.y},
-        Fade(RAYWHITE, alpha)
-      );
+      t = t_maxY;
+      t_maxY += t_deltaY;
+      cellRow += stepRow;
     }
   }
+  hit = createBlastRay(ray_dx, ray_dy, ray_startX + ray_dx * radius, ray_startY + ray_dy * radius);
+  return true;
+}
+
+// Keyed by the ray's direction rather than the hit, which lands on the origin for a blast
+// that starts against a wall
+BlastRay BlastZone::createBlastRay(float ray_dx, float ray_dy, float px, float py) const
+{
+  return { PseudoAngle::fromDirection(ray_dx, ray_dy), px, py };
+}
+
+// The fan is the bomb origin followed by the polygon points in descending angle order and closed
+// with a repeat of the first ring point, so every consecutive pair is already wound for drawing.
+void BlastZone::buildTriangleFan(float originX, float originY)
+{
+  blastZoneTriangleFan.clear();
+  if (blastZonePolygonPoints.size() < 2)
+    return;
+
+  blastZoneTriangleFan.reserve(blastZonePolygonPoints.size() + 2);
+  blastZoneTriangleFan.push_back({ originX, originY });
+  for (auto it = blastZonePolygonPoints.rbegin(); it != blastZonePolygonPoints.rend(); it++)
+    blastZoneTriangleFan.push_back({ it->x, it->y });
+  blastZoneTriangleFan.push_back(blastZoneTriangleFan[1]);
+}
+
+void BlastZone::rasteriseCoverage(const Level& level)
+{
+  // The ring between the fan's origin and its closing repeat is the polygon outline
+  ArrayView<Vertex> outline;
+  if (blastZoneTriangleFan.size() > 2)
+    outline = ArrayView<Vertex>(blastZoneTriangleFan.data() + 1, blastZoneTriangleFan.size() - 2);
+  coverage.rasterise(outline, level.getNumberOfTilesWidth(), level.getNumberOfTilesHeight(), static_cast<float>(level.getTileSize()));
 }
\ No newline at end of file
@@ -1,10 +1,29 @@
-#include "raylib.h"
 #include "Bomb.h"
+#include "Level.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <memory>
+#include <utility>
 
-Bomb::Bomb(float xPosition, float yPosition, float blastDuration, float countDownDuration)
-  : xPosition(xPosition), yPosition(yPosition), blastDuration(blastDuration),
-    countDownDuration(countDownDuration), blastZone(0.0001f, 1000)
+Bomb::Bomb()
+  : Bomb(0, 0, 0, 0)
 {
+}
+
+Bomb::Bomb(float xPosition, float yPosition, float blastDuration, float countDownDuration, float blastRadius, BlastZoneBackend backend)
+  : blastZone(RAY_DEVIANCE, blastRadius, backend), precomputeJobSystem(nullptr)
+{
+  reset(xPosition, yPosition, blastDuration, countDownDuration, blastRadius, backend);
+}
+
+void Bomb::reset(float xPosition, float yPosition, float blastDuration, float countDownDuration, float blastRadius, BlastZoneBackend backend)
+{
+  this->xPosition = xPosition;
+  this->yPosition = yPosition;
+  this->blastDuration = blastDuration;
+  this->countDownDuration = countDownDuration;
+  blastAlpha = 1.0f;
+  blastElapsedTime = 0;
   countDownElapsedTime = 0;
   blastStarted = false;
   blastOver = false;
@@ -12,6 +31,40 @@ Bomb::Bomb(float xPosition, float yPosition, float blastDuration, float countDow
   spriteTintRatio = 1.0f;
   blastSoundPlayed = false;
   lastPlayedBeepSoundTime = -1;
+  blastZone.reset(backend, blastRadius);
+  waitForPrecompute();
+  precomputeJobSystem = nullptr;
+}
+
+Bomb::BlastPrecompute::BlastPrecompute(float rayDeviance, float radius)
+  : blastZone(rayDeviance, radius), pending(0)
+{
+}
+
+// The bomb never moves, so its blast can be traced during the countdown. A level
+// change since then bumps the edge map version and the blast is traced again on detonation.
+void Bomb::startPrecompute(const Level& level, JobSystem& jobSystem)
+{
+  waitForPrecompute();
+  if (!precompute)
+    precompute.reset(new BlastPrecompute(RAY_DEVIANCE, BLAST_RADIUS));
+  precomputeJobSystem = &jobSystem;
+
+  BlastZone* precomputeZone = &precompute->blastZone;
+  precomputeZone->reset(blastZone.getBackend(), blastZone.getRadius());
+  float originX = xPosition;
+  float originY = yPosition;
+  jobSystem.submit([precomputeZone, originX, originY, &level]
+  {
+    PROFILE_SCOPE("Bomb::precompute");
+    precomputeZone->updateBlastZone(originX, originY, level);
+  }, precompute->pending);
+}
+
+void Bomb::waitForPrecompute()
+{
+  if (precomputeJobSystem)
+    precomputeJobSystem->wait(precompute->pending);
 }
 
 float Bomb::getXPosition() const
@@ -34,9 +87,14 @@ float Bomb::getElapsedTime() const
   return blastElapsedTime;
 }
 
-Color Bomb::getSpriteTint() const
+float Bomb::getSpriteTintRatio() const
+{
+  return spriteTintRatio;
+}
+
+const BlastZone& Bomb::getBlastZone() const
 {
-  return (Color) { 255, spriteTintRatio * 255, spriteTintRatio * 255, 255 };
+  return blastZone;
 }
 
 bool Bomb::isBlastStarted() const
@@ -51,29 +109,31 @@ bool Bomb::isBlastOver() const
 
 bool Bomb::isPlayerInBlast(const Player& player) const
 {
-  return blastZone.isPlayerInBlastZone(xPosition, yPosition, player);
+  return blastZone.isPlayerInBlastZone(player);
 }
 
-bool Bomb::update(float frameTime)
+bool Bomb::update(float frameTime, const Level& level)
 {
   if (!blastStarted)
   {
-    return updateCountDown(frameTime);
+    return updateCountDown(frameTime, level);
   }
   else
   {
     updateBlast(frameTime);
+    if (!blastOver)
+      blastZone.updateBlastZone(xPosition, yPosition, level);
     return false;
   }
 }
 
-bool Bomb::updateCountDown(float frameTime)
+bool Bomb::updateCountDown(float frameTime, const Level& level)
 {
   countDownElapsedTime += frameTime;
   spriteTintRatio = 1 - (countDownElapsedTime - (int) countDownElapsedTime);
   if (countDownElapsedTime > countDownDuration)
   {
-    startBlast(frameTime);
+    startBlast(level);
     blastStarted = true;
     updateBlast(countDownElapsedTime - countDownDuration);
     return true;
@@ -88,17 +148,23 @@ void Bomb::updateBlast(float frameTime)
   blastAlpha = blastOver ? 0.0f : 1.0f - (blastElapsedTime / blastDuration);
 }
 
-void Bomb::startBlast(float frameTime)
+void Bomb::startBlast(const Level& level)
 {
   blastElapsedTime = 0;
   blastAlpha = 1.0f;
+  if (precomputeJobSystem)
+  {
+    waitForPrecompute();
+    std::swap(blastZone, precompute->blastZone);
+    precomputeJobSystem = nullptr;
+  }
+  blastZone.updateBlastZone(xPosition, yPosition, level);
 }
 
-bool Bomb::draw(const std::vector<Edge>& edgeMap, const Player& player)
+bool Bomb::checkPlayerHit(const Player& player)
 {
-  if (!blastOver)
+  if (blastStarted && !blastOver)
   {
-    blastZone.drawBlastZone(xPosition, yPosition, edgeMap, blastAlpha);
     if (!playerChecked)
     {
       playerChecked = true;
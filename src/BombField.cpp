@@ -1,76 +1,181 @@
-#include "raylib.h"
 #include "BombField.h"
 #include "Bomb.h"
+#include "Level.h"
 #include "Player.h"
+#include "GameAudio.h"
+#include "JobSystem.h"
+#include "Profiler.h"
 #include <vector>
-#include <string>
+#include <utility>
 
 BombField::BombField()
+  : bombs(MAX_BOMBS), bombSlotIndices(MAX_BOMBS), slots(MAX_BOMBS), bombCount(0), audio(nullptr), jobSystem(nullptr),
+  bombDetonations(MAX_BOMBS)
 {
-  bombSprite = LoadTexture(BOMB_SPRITE_PATH.c_str());
-  explosionSound = LoadSound(EXPLOSION_SOUND_PATH.c_str());
-  beepSound = LoadSound(BEEP_SOUND_PATH.c_str());
+  for (std::size_t i = 0; i < MAX_BOMBS; i++)
+  {
+    slots[i] = { 0, 0 };
+    freeSlots.push_back(MAX_BOMBS - 1 - i);
+  }
 }
 
 BombField::~BombField()
 {
-  UnloadTexture(bombSprite);
-  UnloadSound(explosionSound);
-  UnloadSound(beepSound);
+  waitForBlastPrecomputes();
+}
+
+BombHandle BombField::spawnBomb(float xPosition, float yPosition, float blastDuration, float countDownDuration, float blastRadius, BlastZoneBackend backend, const Level& level)
+{
+  if (freeSlots.empty())
+    return { static_cast<std::uint32_t>(MAX_BOMBS), 0 };
+
+  std::uint32_t slot = freeSlots.back();
+  freeSlots.pop_back();
+
+  bombs[bombCount].reset(xPosition, yPosition, blastDuration, countDownDuration, blastRadius, backend);
+  if (jobSystem)
+    bombs[bombCount].startPrecompute(level, *jobSystem);
+  bombSlotIndices[bombCount] = slot;
+  slots[slot].index = bombCount;
+  bombCount++;
+  return { slot, slots[slot].generation };
+}
+
+bool BombField::isValid(BombHandle handle) const
+{
+  return handle.slot < MAX_BOMBS && slots[handle.slot].generation == handle.generation;
+}
+
+Bomb* BombField::getBomb(BombHandle handle)
+{
+  if (!isValid(handle))
+    return nullptr;
+  return &bombs[slots[handle.slot].index];
+}
+
+const Bomb& BombField::getBomb(std::size_t index) const
+{
+  return bombs[index];
+}
+
+std::size_t BombField::getBombCount() const
+{
+  return bombCount;
+}
+
+void BombField::setAudio(GameAudio* audio)
+{
+  this->audio = audio;
 }
 
-void BombField::addBomb(Bomb* bomb)
+void BombField::setJobSystem(JobSystem* jobSystem)
 {
-  bombs.push_back(bomb);
+  this->jobSystem = jobSystem;
 }
 
-bool BombField::update(float frameTime)
+bool BombField::update(float frameTime, const Level& level)
 {
+  updateBombs(frameTime, level);
+  PROFILE_COUNTER("live bombs", bombCount);
+
   bool bombDetonated = false;
-  for (auto it = bombs.begin(); it != bombs.end(); it++)
+  for (std::size_t i = 0; i < bombCount; i++)
   {
-    if ((*it)->update(frameTime))
+    if (bombDetonations[i])
       bombDetonated = true;
-    if ((*it)->isBlastOver())
+  }
+
+  std::size_t i = 0;
+  while (i < bombCount)
+  {
+    if (bombs[i].isBlastOver())
+    {
+      // The last bomb is swapped into this index, so it is visited next
+      removeBomb(i);
+    }
+    else
     {
-      delete *it;
-      bombs.erase(it--);
+      playBombSounds(bombs[i]);
+      i++;
     }
   }
   return bombDetonated;
 }
 
-bool BombField::drawBombs(const std::vector<Edge>& edgeMap, const Player& player)
+// Bombs only read the level and write their own state, so each one is an independent
+// task. Sounds and removals stay in update, on the calling thread, in bomb order.
+void BombField::updateBombs(float frameTime, const Level& level)
+{
+  auto updateRange = [&](std::size_t begin, std::size_t end)
+  {
+    PROFILE_SCOPE("BombField::updateBombs");
+    for (std::size_t i = begin; i < end; i++)
+      bombDetonations[i] = bombs[i].update(frameTime, level);
+  };
+
+  if (jobSystem)
+    jobSystem->parallelFor(bombCount, 1, updateRange);
+  else
+    updateRange(0, bombCount);
+}
+
+bool BombField::checkPlayerHit(const Player& player)
 {
   bool playerHit = false;
-  for (auto it = bombs.begin(); it != bombs.end(); it++)
+  for (std::size_t i = 0; i < bombCount; i++)
   {
-    if (!(*it)->isBlastStarted())
-    {
-      DrawTexture(bombSprite, (*it)->getXPosition() - BOMB_SPRITE_WIDTH / 2, (*it)->getYPosition() - BOMB_SPRITE_WIDTH / 2, (*it)->getSpriteTint());
-      if ((*it)->shouldPlayBeepSound())
-      {
-        PlaySound(beepSound);
-        (*it)->setLastPlayedBeepSoundTime();
-      }
-    }
-    else
+    if (bombs[i].checkPlayerHit(player))
+      playerHit = true;
+  }
+  return playerHit;
+}
+
+void BombField::removeBomb(std::size_t index)
+{
+  std::uint32_t slot = bombSlotIndices[index];
+  std::size_t last = bombCount - 1;
+
+  if (index != last)
+  {
+    std::swap(bombs[index], bombs[last]);
+    bombSlotIndices[index] = bombSlotIndices[last];
+    slots[bombSlotIndices[index]].index = index;
+  }
+
+  slots[slot].generation++;
+  freeSlots.push_back(slot);
+  bombCount--;
+}
+
+void BombField::playBombSounds(Bomb& bomb)
+{
+  if (!bomb.isBlastStarted())
+  {
+    if (bomb.shouldPlayBeepSound())
     {
-      if ((*it)->draw(edgeMap, player))
-        playerHit = true;
-      if (!(*it)->isBlastSoundPlayed())
-      {
-        PlaySound(explosionSound);
-        (*it)->setBlastSoundPlayed();
-      }
+      if (audio)
+        audio->playBeepSound();
+      bomb.setLastPlayedBeepSoundTime();
     }
   }
-  return playerHit;
+  else if (!bomb.isBlastSoundPlayed())
+  {
+    if (audio)
+      audio->playExplosionSound();
+    bomb.setBlastSoundPlayed();
+  }
+}
+
+// Precompute jobs read the level, so it must not change while any are still running
+void BombField::waitForBlastPrecomputes()
+{
+  for (std::size_t i = 0; i < bombCount; i++)
+    bombs[i].waitForPrecompute();
 }
 
 void BombField::clearBombField()
 {
-  for (Bomb* bomb: bombs)
-    delete bomb;
-  bombs.clear();
+  waitForBlastPrecomputes();
+  while (bombCount > 0)
+    removeBomb(bombCount - 1);
 }
\ No newline at end of file
@@ -1,39 +1,19 @@
-#include "raylib.h"
 #include "Cell.h"
 
 Cell::Cell()
-  : color(BLUE), existsFlag(false)
+  : color({ 0, 121, 241, 255 })
 {
-}
-
-bool Cell::exists() const
-{
-  return existsFlag;
-}
-
-void Cell::place()
-{
-  existsFlag = true;
-}
-
-void Cell::remove()
-{
-  existsFlag = false;
+  clearAllEdges();
 }
 
 bool Cell::edgeExists(Direction direction) const
 {
-  return edgeExistsArray[static_cast<int>(direction)];
-}
-
-void Cell::addEdge(Direction direction)
-{
-  edgeExistsArray[static_cast<int>(direction)] = true;
+  return edgeIDArray[static_cast<int>(direction)] != -1;
 }
 
 void Cell::removeEdge(Direction direction)
 {
-  edgeExistsArray[static_cast<int>(direction)] = false;
+  edgeIDArray[static_cast<int>(direction)] = -1;
 }
 
 int Cell::getEdgeID(Direction direction) const
@@ -48,25 +28,5 @@ void Cell::setEdgeID(Direction direction, int id)
 
 void Cell::clearAllEdges()
 {
-  for (Direction direction : ALL_DIRECTIONS)
-  {
-    removeEdge(direction);
-    setEdgeID(direction, 0);
-  }
-}
-
-void Cell::setCoordinates(int x, int y)
-{
-  this->x = x;
-  this->y = y;
-}
-
-int Cell::getX() const
-{
-  return x;
-}
-
-int Cell::getY() const
-{
-  return y;
+  edgeIDArray.fill(-1);
 }
\ No newline at end of file
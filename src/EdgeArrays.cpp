@@ -0,0 +1,128 @@
+#include "EdgeArrays.h"
+#include "Edge.h"
+#include <vector>
+#include <cmath>
+
+EdgeArrays::EdgeArrays()
+{
+  clear(verticalEdges);
+  clear(horizontalEdges);
+}
+
+void EdgeArrays::assign(const std::vector<Edge>& edgeMap)
+{
+  clear(verticalEdges);
+  clear(horizontalEdges);
+  edgeSlots.clear();
+
+  for (std::size_t i = 0; i < edgeMap.size(); i++)
+    addEdge(i, edgeMap[i]);
+}
+
+void EdgeArrays::addEdge(int edgeID, const Edge& edge)
+{
+  bool vertical = edge.startX == edge.endX;
+  AxisAlignedEdges& edges = getGroup(vertical);
+
+  // Grow a whole lane block at a time so the kernels can always read full vectors
+  if (edges.count == edges.position.size())
+  {
+    std::size_t paddedSize = edges.position.size() + LANE_PADDING;
+    edges.position.resize(paddedSize, NAN);
+    edges.start.resize(paddedSize, NAN);
+    edges.end.resize(paddedSize, NAN);
+    edges.edgeIDs.resize(paddedSize, -1);
+  }
+
+  std::size_t index = edges.count++;
+  writeSlot(edges, index, edge);
+  edges.edgeIDs[index] = edgeID;
+
+  if (static_cast<std::size_t>(edgeID) >= edgeSlots.size())
+    edgeSlots.resize(edgeID + 1);
+  edgeSlots[edgeID] = { vertical, index };
+}
+
+void EdgeArrays::updateEdge(int edgeID, const Edge& edge)
+{
+  EdgeSlot slot = edgeSlots[edgeID];
+  writeSlot(getGroup(slot.vertical), slot.index, edge);
+}
+
+void EdgeArrays::removeEdge(int edgeID)
+{
+  EdgeSlot slot = edgeSlots[edgeID];
+  AxisAlignedEdges& edges = getGroup(slot.vertical);
+  std::size_t last = edges.count - 1;
+
+  if (slot.index != last)
+  {
+    edges.position[slot.index] = edges.position[last];
+    edges.start[slot.index] = edges.start[last];
+    edges.end[slot.index] = edges.end[last];
+    edges.edgeIDs[slot.index] = edges.edgeIDs[last];
+    edgeSlots[edges.edgeIDs[slot.index]].index = slot.index;
+  }
+
+  clearSlot(edges, last);
+  edges.count--;
+}
+
+void EdgeArrays::renameEdge(int oldEdgeID, int newEdgeID)
+{
+  EdgeSlot slot = edgeSlots[oldEdgeID];
+  getGroup(slot.vertical).edgeIDs[slot.index] = newEdgeID;
+
+  if (static_cast<std::size_t>(newEdgeID) >= edgeSlots.size())
+    edgeSlots.resize(newEdgeID + 1);
+  edgeSlots[newEdgeID] = slot;
+}
+
+const AxisAlignedEdges& EdgeArrays::getVerticalEdges() const
+{
+  return verticalEdges;
+}
+
+const AxisAlignedEdges& EdgeArrays::getHorizontalEdges() const
+{
+  return horizontalEdges;
+}
+
+AxisAlignedEdges& EdgeArrays::getGroup(bool vertical)
+{
+  return vertical ? verticalEdges : horizontalEdges;
+}
+
+void EdgeArrays::clear(AxisAlignedEdges& edges)
+{
+  edges.position.clear();
+  edges.start.clear();
+  edges.end.clear();
+  edges.edgeIDs.clear();
+  edges.count = 0;
+}
+
+void EdgeArrays::writeSlot(AxisAlignedEdges& edges, std::size_t index, const Edge& edge)
+{
+  if (edge.startX == edge.endX)
+  {
+    edges.position[index] = edge.startX;
+    edges.start[index] = edge.startY;
+    edges.end[index] = edge.endY;
+  }
+  else
+  {
+    edges.position[index] = edge.startY;
+    edges.start[index] = edge.startX;
+    edges.end[index] = edge.endX;
+  }
+}
+
+void EdgeArrays::clearSlot(AxisAlignedEdges& edges, std::size_t index)
+{
+  // NaN lanes fail every comparison in the ray kernels, so they never produce a hit
+  edges.position[index] = NAN;
+  edges.start[index] = NAN;
+  edges.end[index] = NAN;
+  edges.edgeIDs[index] = -1;
+}
\ No newline at end of file
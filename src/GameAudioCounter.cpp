@@ -0,0 +1,26 @@
+#include "GameAudioCounter.h"
+
+GameAudioCounter::GameAudioCounter()
+  : beepCount(0), explosionCount(0)
+{
+}
+
+void GameAudioCounter::playBeepSound()
+{
+  beepCount++;
+}
+
+void GameAudioCounter::playExplosionSound()
+{
+  explosionCount++;
+}
+
+int GameAudioCounter::getBeepCount() const
+{
+  return beepCount;
+}
+
+int GameAudioCounter::getExplosionCount() const
+{
+  return explosionCount;
+}
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include "raylib.h"
+#include "rlgl.h"
+#include "GameRenderer.h"
+#include "SimulationSnapshot.h"
+#include "Direction.h"
+#include "Vertex.h"
+#include "Profiler.h"
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+
+GameRenderer::GameRenderer()
+  : chunkLayerTilesWidth(-1)
+{
+  tileSprite = LoadTexture(TILE_SPRITE_PATH.c_str());
+  bombSprite = LoadTexture(BOMB_SPRITE_PATH.c_str());
+  playerSprite = LoadTexture(PLAYER_SPRITE_PATH.c_str());
+}
+
+GameRenderer::~GameRenderer()
+{
+  UnloadTexture(tileSprite);
+  UnloadTexture(bombSprite);
+  UnloadTexture(playerSprite);
+  for (auto& chunkLayer : chunkLayers)
+    UnloadRenderTexture(chunkLayer.second.texture);
+}
+
+// Must be called outside BeginMode2D, since texture mode resets the camera transform.
+// Brings the chunks overlapping the view up to date and drops the rest, so the memory
+// and drawing cost follow the screen size rather than the level size.
+void GameRenderer::updateTileLayer(const TileSnapshot& tiles, Rectangle view)
+{
+  PROFILE_SCOPE("GameRenderer::updateTileLayer");
+  int chunkWidth = tiles.chunkSize * tiles.tileSize;
+  int nChunksWidth = (tiles.nTilesWidth + tiles.chunkSize - 1) / tiles.chunkSize;
+  int nChunksHeight = (tiles.nTilesHeight + tiles.chunkSize - 1) / tiles.chunkSize;
+  if (chunkLayerTilesWidth != tiles.nTilesWidth)
+  {
+    for (auto& chunkLayer : chunkLayers)
+      UnloadRenderTexture(chunkLayer.second.texture);
+    chunkLayers.clear();
+    chunkLayerTilesWidth = tiles.nTilesWidth;
+  }
+
+  for (auto& chunkLayer : chunkLayers)
+    chunkLayer.second.visible = false;
+
+  int firstColumn = std::max(static_cast<int>(std::floor(view.x / chunkWidth)), 0);
+  int lastColumn = std::min(static_cast<int>(std::floor((view.x + view.width) / chunkWidth)), nChunksWidth - 1);
+  int firstRow = std::max(static_cast<int>(std::floor(view.y / chunkWidth)), 0);
+  int lastRow = std::min(static_cast<int>(std::floor((view.y + view.height) / chunkWidth)), nChunksHeight - 1);
+  for (int row = firstRow; row <= lastRow; row++)
+  {
+    for (int column = firstColumn; column <= lastColumn; column++)
+      updateChunkLayer(tiles, column, row);
+  }
+
+  for (auto it = chunkLayers.begin(); it != chunkLayers.end();)
+  {
+    if (it->second.visible)
+    {
+      it++;
+      continue;
+    }
+    UnloadRenderTexture(it->second.texture);
+    it = chunkLayers.erase(it);
+  }
+}
+
+void GameRenderer::updateChunkLayer(const TileSnapshot& tiles, int column, int row)
+{
+  int chunkWidth = tiles.chunkSize * tiles.tileSize;
+  int nChunksWidth = (tiles.nTilesWidth + tiles.chunkSize - 1) / tiles.chunkSize;
+  auto inserted = chunkLayers.emplace(row * nChunksWidth + column, ChunkLayer());
+  ChunkLayer& chunkLayer = inserted.first->second;
+  chunkLayer.visible = true;
+  if (inserted.second)
+  {
+    chunkLayer.texture = LoadRenderTexture(chunkWidth, chunkWidth);
+    chunkLayer.position = { static_cast<float>(column * chunkWidth), static_cast<float>(row * chunkWidth) };
+    chunkLayer.generation = -1;
+    chunkLayer.toggleCount = 0;
+  }
+
+  int firstTileColumn = column * tiles.chunkSize;
+  int firstTileRow = row * tiles.chunkSize;
+  int lastTileColumn = std::min(firstTileColumn + tiles.chunkSize, tiles.nTilesWidth) - 1;
+  int lastTileRow = std::min(firstTileRow + tiles.chunkSize, tiles.nTilesHeight) - 1;
+  const std::vector<int>& toggledCells = tiles.toggledCells;
+  if (chunkLayer.generation != tiles.generation)
+  {
+    BeginTextureMode(chunkLayer.texture);
+    ClearBackground(BLANK);
+    for (int tileRow = firstTileRow; tileRow <= lastTileRow; tileRow++)
+    {
+      for (int tileColumn = firstTileColumn; tileColumn <= lastTileColumn; tileColumn++)
+        drawTile(tiles, tileRow * tiles.nTilesWidth + tileColumn, chunkLayer.position);
+    }
+    EndTextureMode();
+    chunkLayer.generation = tiles.generation;
+    chunkLayer.toggleCount = toggledCells.size();
+    return;
+  }
+
+  bool textureModeStarted = false;
+  for (; chunkLayer.toggleCount < toggledCells.size(); chunkLayer.toggleCount++)
+  {
+    int cellIndex = toggledCells[chunkLayer.toggleCount];
+    int tileColumn = cellIndex % tiles.nTilesWidth;
+    int tileRow = cellIndex / tiles.nTilesWidth;
+    if (tileColumn < firstTileColumn || tileColumn > lastTileColumn || tileRow < firstTileRow || tileRow > lastTileRow)
+      continue;
+    if (!textureModeStarted)
+    {
+      BeginTextureMode(chunkLayer.texture);
+      textureModeStarted = true;
+    }
+    drawTile(tiles, cellIndex, chunkLayer.position);
+  }
+  if (textureModeStarted)
+    EndTextureMode();
+}
+
+void GameRenderer::drawLevel() const
+{
+  PROFILE_SCOPE("GameRenderer::drawLevel");
+  for (const auto& chunkLayer : chunkLayers)
+  {
+    const RenderTexture2D& texture = chunkLayer.second.texture;
+    // Render textures are stored upside down, so flip the source rectangle
+    Rectangle source = { 0, 0, static_cast<float>(texture.texture.width), -static_cast<float>(texture.texture.height) };
+    DrawTextureRec(texture.texture, source, chunkLayer.second.position, WHITE);
+  }
+}
+
+void GameRenderer::drawTile(const TileSnapshot& tiles, int cellIndex, Vector2 origin) const
+{
+  float tileSize = static_cast<float>(tiles.tileSize);
+  Vector2 position = { static_cast<float>(cellIndex % tiles.nTilesWidth) * tileSize - origin.x, static_cast<float>(cellIndex / tiles.nTilesWidth) * tileSize - origin.y };
+  if (tiles.occupancy.test(cellIndex))
+    DrawTextureRec(tileSprite, { tileSize, 0, tileSize, tileSize }, position, RAYWHITE);
+  else
+    DrawTextureRec(tileSprite, { 0, 0, tileSize, tileSize }, position, RAYWHITE);
+}
+
+void GameRenderer::drawBombs(const SimulationSnapshot& snapshot, Rectangle view) const
+{
+  PROFILE_SCOPE("GameRenderer::drawBombs");
+  for (const BombSnapshot& bomb : snapshot.bombs)
+  {
+    if (!bomb.blastStarted)
+    {
+      if (bomb.xPosition + BOMB_SPRITE_WIDTH < view.x || bomb.xPosition - BOMB_SPRITE_WIDTH > view.x + view.width
+        || bomb.yPosition + BOMB_SPRITE_WIDTH < view.y || bomb.yPosition - BOMB_SPRITE_WIDTH > view.y + view.height)
+        continue;
+      unsigned char tint = static_cast<unsigned char>(bomb.spriteTintRatio * 255);
+      DrawTexture(bombSprite, bomb.xPosition - BOMB_SPRITE_WIDTH / 2, bomb.yPosition - BOMB_SPRITE_WIDTH / 2, { 255, tint, tint, 255 });
+    }
+    else
+    {
+      drawBlastZone(bomb.triangleFan, bomb.blastAlpha);
+    }
+  }
+}
+
+void GameRenderer::drawPlayer(const SimulationSnapshot& previous, const SimulationSnapshot& latest, float interpolation, float alpha) const
+{
+  Vector2 position = getPlayerPosition(previous, latest, interpolation);
+  if (latest.playerDirection == Direction::WEST)
+    DrawTextureRec(playerSprite, { 0, 0, static_cast<float>(PLAYER_SPRITE_WIDTH), static_cast<float>(PLAYER_SPRITE_WIDTH) }, position, Fade(RAYWHITE, alpha));
+  else
+    DrawTextureRec(playerSprite, { static_cast<float>(PLAYER_SPRITE_WIDTH), 0, static_cast<float>(PLAYER_SPRITE_WIDTH), static_cast<float>(PLAYER_SPRITE_WIDTH) }, position, Fade(RAYWHITE, alpha));
+}
+
+void GameRenderer::drawBlastZone(const std::vector<Vertex>& triangleFan, float alpha) const
+{
+  if (triangleFan.size() < 3)
+    return;
+
+  Color color = Fade(RAYWHITE, alpha);
+  const Vertex& origin = triangleFan[0];
+  std::size_t i = 1;
+  while (i + 1 < triangleFan.size())
+  {
+    std::size_t batchEnd = std::min(triangleFan.size() - 1, i + BLAST_ZONE_BATCH_TRIANGLES);
+    rlCheckRenderBatchLimit(3 * (batchEnd - i));
+    rlBegin(RL_TRIANGLES);
+    rlColor4ub(color.r, color.g, color.b, color.a);
+    for (; i < batchEnd; i++)
+    {
+      rlVertex2f(origin.x, origin.y);
+      rlVertex2f(triangleFan[i].x, triangleFan[i].y);
+      rlVertex2f(triangleFan[i+1].x, triangleFan[i+1].y);
+    }
+    rlEnd();
+  }
+}
+
+// Blends the player between two ticks; a restart in between makes the move a teleport, so no blending
+Vector2 GameRenderer::getPlayerPosition(const SimulationSnapshot& previous, const SimulationSnapshot& latest, float interpolation)
+{
+  if (previous.gameIndex != latest.gameIndex)
+    return { latest.playerX, latest.playerY };
+  return { previous.playerX + (latest.playerX - previous.playerX) * interpolation,
+    previous.playerY + (latest.playerY - previous.playerY) * interpolation };
+}
\ No newline at end of file
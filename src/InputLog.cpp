@@ -0,0 +1,185 @@
+#include "InputLog.h"
+#include "PlayerInput.h"
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+
+namespace
+{
+  // Fixed little-endian encoding so logs move between machines
+  void writeUnsigned(std::ofstream& file, std::uint64_t value, int bytes)
+  {
+    for (int i = 0; i < bytes; i++)
+      file.put(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+
+  bool readUnsigned(std::ifstream& file, std::uint64_t& value, int bytes)
+  {
+    value = 0;
+    for (int i = 0; i < bytes; i++)
+    {
+      int byte = file.get();
+      if (byte == std::char_traits<char>::eof())
+        return false;
+      value |= static_cast<std::uint64_t>(byte) << (8 * i);
+    }
+    return true;
+  }
+
+  void writeFloat(std::ofstream& file, float value)
+  {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeUnsigned(file, bits, 4);
+  }
+
+  bool readFloat(std::ifstream& file, float& value)
+  {
+    std::uint64_t bits;
+    if (!readUnsigned(file, bits, 4))
+      return false;
+    std::uint32_t floatBits = static_cast<std::uint32_t>(bits);
+    std::memcpy(&value, &floatBits, sizeof(value));
+    return true;
+  }
+}
+
+InputLog::InputLog()
+  : InputLog(0, 0, 0, 0)
+{
+}
+
+InputLog::InputLog(std::uint64_t seed, int nTilesWidth, int nTilesHeight, int tileSize)
+  : seed(seed), nTilesWidth(nTilesWidth), nTilesHeight(nTilesHeight), tileSize(tileSize), finalState({ 0.0f, 0.0f, 0 })
+{
+}
+
+void InputLog::recordFrame(const PlayerInput& input, bool restart, float frameTime)
+{
+  std::uint8_t mask = encodeInput(input);
+  if (restart)
+    mask |= RESTART_BIT;
+  inputMasks.push_back(mask);
+  frameTimes.push_back(frameTime);
+}
+
+void InputLog::setFinalState(const FinalState& finalState)
+{
+  this->finalState = finalState;
+}
+
+bool InputLog::save(const std::string& path) const
+{
+  std::ofstream file(path, std::ios::binary);
+  if (!file)
+    return false;
+
+  writeUnsigned(file, FILE_MAGIC, 4);
+  writeUnsigned(file, FILE_VERSION, 4);
+  writeUnsigned(file, seed, 8);
+  writeUnsigned(file, nTilesWidth, 4);
+  writeUnsigned(file, nTilesHeight, 4);
+  writeUnsigned(file, tileSize, 4);
+  writeUnsigned(file, inputMasks.size(), 4);
+  writeFloat(file, finalState.playerX);
+  writeFloat(file, finalState.playerY);
+  writeUnsigned(file, static_cast<std::uint32_t>(finalState.bombsSpawned), 4);
+
+  for (std::size_t i = 0; i < inputMasks.size(); i++)
+  {
+    file.put(static_cast<char>(inputMasks[i]));
+    writeFloat(file, frameTimes[i]);
+  }
+  return static_cast<bool>(file);
+}
+
+bool InputLog::load(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    return false;
+
+  std::uint64_t magic, version, width, height, size, frameCount, bombsSpawned;
+  if (!readUnsigned(file, magic, 4) || magic != FILE_MAGIC)
+    return false;
+  if (!readUnsigned(file, version, 4) || version != FILE_VERSION)
+    return false;
+  if (!readUnsigned(file, seed, 8) || !readUnsigned(file, width, 4) || !readUnsigned(file, height, 4)
+    || !readUnsigned(file, size, 4) || !readUnsigned(file, frameCount, 4))
+    return false;
+  if (!readFloat(file, finalState.playerX) || !readFloat(file, finalState.playerY) || !readUnsigned(file, bombsSpawned, 4))
+    return false;
+
+  nTilesWidth = static_cast<int>(width);
+  nTilesHeight = static_cast<int>(height);
+  tileSize = static_cast<int>(size);
+  finalState.bombsSpawned = static_cast<std::int32_t>(bombsSpawned);
+
+  inputMasks.resize(frameCount);
+  frameTimes.resize(frameCount);
+  for (std::size_t i = 0; i < frameCount; i++)
+  {
+    std::uint64_t mask;
+    if (!readUnsigned(file, mask, 1) || !readFloat(file, frameTimes[i]))
+      return false;
+    inputMasks[i] = static_cast<std::uint8_t>(mask);
+  }
+  return true;
+}
+
+std::uint64_t InputLog::getSeed() const
+{
+  return seed;
+}
+
+int InputLog::getNumberOfTilesWidth() const
+{
+  return nTilesWidth;
+}
+
+int InputLog::getNumberOfTilesHeight() const
+{
+  return nTilesHeight;
+}
+
+int InputLog::getTileSize() const
+{
+  return tileSize;
+}
+
+std::size_t InputLog::getFrameCount() const
+{
+  return inputMasks.size();
+}
+
+PlayerInput InputLog::getInput(std::size_t frame) const
+{
+  return decodeInput(inputMasks[frame]);
+}
+
+bool InputLog::isRestart(std::size_t frame) const
+{
+  return (inputMasks[frame] & RESTART_BIT) != 0;
+}
+
+float InputLog::getFrameTime(std::size_t frame) const
+{
+  return frameTimes[frame];
+}
+
+const InputLog::FinalState& InputLog::getFinalState() const
+{
+  return finalState;
+}
+
+std::uint8_t InputLog::encodeInput(const PlayerInput& input)
+{
+  return (input.north ? 1 : 0) | (input.south ? 2 : 0) | (input.east ? 4 : 0) | (input.west ? 8 : 0);
+}
+
+PlayerInput InputLog::decodeInput(std::uint8_t mask)
+{
+  return { (mask & 1) != 0, (mask & 2) != 0, (mask & 4) != 0, (mask & 8) != 0 };
+}
\ No newline at end of file
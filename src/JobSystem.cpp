@@ -0,0 +1,177 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+  thread_local bool insideJob = false;
+}
+
+JobSystem::JobSystem(int workerCount)
+  : pendingTasks(0), nextQueue(0), stopping(false)
+{
+  workerCount = std::max(workerCount, 0);
+  for (int i = 0; i <= workerCount; i++)
+    queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+  for (int i = 1; i <= workerCount; i++)
+    workers.emplace_back(&JobSystem::workerLoop, this, static_cast<std::size_t>(i));
+}
+
+JobSystem::~JobSystem()
+{
+  {
+    std::lock_guard<std::mutex> lock(wakeMutex);
+    stopping = true;
+  }
+  wakeCondition.notify_all();
+  for (std::thread& worker : workers)
+    worker.join();
+}
+
+int JobSystem::getThreadCount() const
+{
+  return static_cast<int>(queues.size());
+}
+
+// Queues a job that runs in the background and decrements counter when it is done.
+// With no workers there is no background, so the job runs straight away.
+void JobSystem::submit(Job job, JobCounter& counter)
+{
+  if (workers.empty())
+  {
+    job();
+    return;
+  }
+  counter++;
+  pushTask(nextQueue++ % queues.size(), { std::move(job), &counter });
+  wakeCondition.notify_one();
+}
+
+void JobSystem::wait(const JobCounter& counter)
+{
+  Task task;
+  while (counter.load(std::memory_order_acquire) > 0)
+  {
+    if (takeTask(0, task))
+      runTask(task);
+    else
+      std::this_thread::yield();
+  }
+}
+
+// Splits [0, count) into tasks of at most grainSize items and returns once all of them
+// have run. Calls made from inside a job run inline, so nested loops never block a worker.
+void JobSystem::parallelFor(std::size_t count, std::size_t grainSize, const RangeJob& job)
+{
+  if (count == 0)
+    return;
+  grainSize = std::max<std::size_t>(grainSize, 1);
+  if (workers.empty() || count <= grainSize || insideJob)
+  {
+    job(0, count);
+    return;
+  }
+
+  std::size_t taskCount = (count + grainSize - 1) / grainSize;
+  JobCounter remaining(taskCount);
+  for (std::size_t i = 0; i < taskCount; i++)
+  {
+    std::size_t begin = i * grainSize;
+    std::size_t end = std::min(count, begin + grainSize);
+    pushTask(i % queues.size(), { [&job, begin, end] { job(begin, end); }, &remaining });
+  }
+  wakeCondition.notify_all();
+  wait(remaining);
+}
+
+bool JobSystem::isInsideJob()
+{
+  return insideJob;
+}
+
+void JobSystem::workerLoop(std::size_t queueIndex)
+{
+  PROFILE_THREAD_NAME("job worker");
+  Task task;
+  while (true)
+  {
+    if (takeTask(queueIndex, task))
+    {
+      runTask(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    wakeCondition.wait(lock, [this] { return stopping || pendingTasks.load() > 0; });
+    if (stopping)
+      return;
+  }
+}
+
+void JobSystem::pushTask(std::size_t queueIndex, Task task)
+{
+  {
+    // Counted before the push so a worker that takes the task never sees the count underflow
+    std::lock_guard<std::mutex> lock(wakeMutex);
+    pendingTasks++;
+  }
+  WorkQueue& queue = *queues[queueIndex];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  queue.tasks.push_back(std::move(task));
+}
+
+bool JobSystem::takeTask(std::size_t queueIndex, Task& task)
+{
+  if (popTask(queueIndex, task) || stealTask(queueIndex, task))
+  {
+    pendingTasks--;
+    return true;
+  }
+  return false;
+}
+
+// The owner works from the back of its queue and thieves from the front, so they
+// only meet on the last task
+bool JobSystem::popTask(std::size_t queueIndex, Task& task)
+{
+  WorkQueue& queue = *queues[queueIndex];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tasks.empty())
+    return false;
+  task = std::move(queue.tasks.back());
+  queue.tasks.pop_back();
+  return true;
+}
+
+bool JobSystem::stealTask(std::size_t queueIndex, Task& task)
+{
+  for (std::size_t i = 1; i < queues.size(); i++)
+  {
+    WorkQueue& queue = *queues[(queueIndex + i) % queues.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty())
+    {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void JobSystem::runTask(Task& task)
+{
+  bool wasInsideJob = insideJob;
+  insideJob = true;
+  task.job();
+  task.job = nullptr;
+  insideJob = wasInsideJob;
+  task.remaining->fetch_sub(1, std::memory_order_release);
+}
\ No newline at end of file
@@ -1,61 +1,82 @@
-#include "raylib.h"
 #include "Level.h"
+#include "Profiler.h"
 #include <iostream>
-#include <string>
 #include <vector>
 #include <utility>
-#include <ctime>
 #include <cstdlib>
+#include <cstdint>
+#include <array>
+#include <algorithm>
+#include <cmath>
 
-Level::Level(int nTilesWidth, int nTilesHeight, int tileSize)
+Level::Level(int nTilesWidth, int nTilesHeight, int tileSize, RandomStream random)
   : nTilesWidth(nTilesWidth), nTilesHeight(nTilesHeight), tileSize(tileSize),
-    timeSinceLastSpawn(0), bombSpawnCount(0), bombDetonatedCount(0)
+    timeSinceLastSpawn(0), cellProbability(CELL_PROBABILITY), blastRadius(Bomb::BLAST_RADIUS), bombSpawnCount(0), bombDetonatedCount(0), edgeMapVersion(0),
+    tileMapGeneration(0), blastZoneBackend(BlastZoneBackend::EDGE_MAP), random(random)
 {
-  std::srand(std::time(NULL));
   spawnProbability = MIN_SPAWN_PROBABILITY;
   spawnDelay = INITIAL_SPAWN_DELAY;
-  tileSprite = LoadTexture(TILE_SPRITE_PATH.c_str());
   tileCount = nTilesWidth * nTilesHeight;
+  nChunksWidth = (nTilesWidth + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  nChunksHeight = (nTilesHeight + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  chunks.resize(nChunksWidth * nChunksHeight);
+  cornerRefCounts.resize((nTilesWidth + 1) * (nTilesHeight + 1));
+  cornerPositions.resize((nTilesWidth + 1) * (nTilesHeight + 1));
   createTileMap();
 }
 
-Level::~Level()
-{
-  UnloadTexture(tileSprite);
-}
-
 bool Level::addTileToMap(int xPosition, int yPosition)
 {
+  PROFILE_SCOPE("Level::addTileToMap");
   int cellIndex = coordinateToCellIndex(xPosition, yPosition);
   if (isBorderIndex(cellIndex))
     return false;
 
-  if (tileMap[cellIndex].exists())
-    tileMap[cellIndex].remove();
-  else
-    tileMap[cellIndex].place();
+  bombField.waitForBlastPrecomputes();
+  occupancy.flip(cellIndex);
+  updateEmptyCellIndex(cellIndex);
+  toggledCells.push_back(cellIndex);
 
-  convertTileMapToEdgeMap();
+  edgeRemaps.clear();
+  for (Direction direction : ALL_DIRECTIONS)
+  {
+    updateEdgeSegment(direction, cellIndex);
+    updateEdgeSegment(getOppositeDirection(direction), calculateNeighborIndex(direction, cellIndex));
+  }
+  edgeMapVersion++;
 
   return true;
 }
 
-void Level::addBombToMap(Bomb* bomb)
+bool Level::addBombToMap(float xPosition, float yPosition)
 {
-  bombField.addBomb(bomb);
+  BombHandle handle = bombField.spawnBomb(xPosition, yPosition, 1.5f, 3.0f, blastRadius, blastZoneBackend, *this);
+  if (!bombField.isValid(handle))
+    return false;
   bombSpawnCount++;
+  return true;
+}
+
+bool Level::cellExists(int cellIndex) const
+{
+  return occupancy.test(cellIndex);
 }
 
 bool Level::cellExistsAtCoordinate(int xPosition, int yPosition) const
 {
-  return tileMap[coordinateToCellIndex(xPosition, yPosition)].exists();
+  return occupancy.test(coordinateToCellIndex(xPosition, yPosition));
 }
 
-std::vector<Cell> Level::getTileMap() const
+ArrayView<Cell> Level::getTileMap() const
 {
   return tileMap;
 }
 
+const OccupancyGrid& Level::getOccupancyGrid() const
+{
+  return occupancy;
+}
+
 int Level::getTileCount() const
 {
   return tileCount;
@@ -76,55 +97,141 @@ int Level::getNumberOfTilesHeight() const
   return nTilesHeight;
 }
 
-std::vector<Edge> Level::getEdgeMap() const
+ArrayView<Edge> Level::getEdgeMap() const
 {
   return edgeMap;
 }
 
-int Level::getBombSpawnCount() const
+int Level::getEdgeMapVersion() const
 {
-  return bombSpawnCount;
+  return edgeMapVersion;
 }
 
-int Level::getBombDetonatedCount() const
+int Level::getChunkCountWidth() const
 {
-  return bombDetonatedCount;
+  return nChunksWidth;
 }
 
-void Level::drawMap()
+int Level::getChunkCountHeight() const
 {
-  #pragma omp parallel for
-  for (std::size_t i = 0; i < tileMap.size(); i++)
+  return nChunksHeight;
+}
+
+const LevelChunk& Level::getChunk(int column, int row) const
+{
+  return chunks[row * nChunksWidth + column];
+}
+
+// Chunks touching the box, clamped to the level. Points on a chunk border count towards
+// the chunk after it, the same rule edges are filed by, so a query always finds the edges
+// at its own boundary.
+ChunkRange Level::getChunkRange(float minX, float minY, float maxX, float maxY) const
+{
+  float chunkWidth = static_cast<float>(CHUNK_SIZE * tileSize);
+  ChunkRange range;
+  range.firstColumn = std::max(static_cast<int>(std::floor(minX / chunkWidth)), 0);
+  range.lastColumn = std::min(static_cast<int>(std::floor(maxX / chunkWidth)), nChunksWidth - 1);
+  range.firstRow = std::max(static_cast<int>(std::floor(minY / chunkWidth)), 0);
+  range.lastRow = std::min(static_cast<int>(std::floor(maxY / chunkWidth)), nChunksHeight - 1);
+  return range;
+}
+
+// Sorted and without the repeats of edges that span several chunks
+void Level::getEdgeIDsInChunks(const ChunkRange& range, std::vector<int>& edgeIDs) const
+{
+  edgeIDs.clear();
+  for (int row = range.firstRow; row <= range.lastRow; row++)
   {
-    if (tileMap[i].exists())
+    for (int column = range.firstColumn; column <= range.lastColumn; column++)
     {
-      #pragma omp critical(drawLevelTile)
-      {
-        DrawTextureRec(tileSprite, { static_cast<float>(tileSize), 0, static_cast<float>(tileSize), static_cast<float>(tileSize) }, { getCellX(i), getCellY(i) }, RAYWHITE);
-      }
+      const LevelChunk& chunk = getChunk(column, row);
+      edgeIDs.insert(edgeIDs.end(), chunk.edgeIDs.begin(), chunk.edgeIDs.end());
     }
-    else
+  }
+  std::sort(edgeIDs.begin(), edgeIDs.end());
+  edgeIDs.erase(std::unique(edgeIDs.begin(), edgeIDs.end()), edgeIDs.end());
+}
+
+// Every corner lives in exactly one chunk, so there are no repeats to remove
+void Level::getCornersInChunks(const ChunkRange& range, std::vector<Corner>& corners) const
+{
+  corners.clear();
+  for (int row = range.firstRow; row <= range.lastRow; row++)
+  {
+    for (int column = range.firstColumn; column <= range.lastColumn; column++)
     {
-      #pragma omp critical(drawLevelTile)
+      for (int cornerID : getChunk(column, row).cornerIDs)
       {
-        DrawTextureRec(tileSprite, { 0, 0, static_cast<float>(tileSize), static_cast<float>(tileSize) }, { getCellX(i), getCellY(i) }, RAYWHITE);
+        int cornerColumn = cornerID % (nTilesWidth + 1);
+        int cornerRow = cornerID / (nTilesWidth + 1);
+        unsigned char filledQuadrants = cellExistsAtCell(cornerColumn - 1, cornerRow - 1)
+          | cellExistsAtCell(cornerColumn, cornerRow - 1) << 1
+          | cellExistsAtCell(cornerColumn - 1, cornerRow) << 2
+          | cellExistsAtCell(cornerColumn, cornerRow) << 3;
+        corners.push_back({ static_cast<float>(cornerColumn * tileSize), static_cast<float>(cornerRow * tileSize), filledQuadrants });
       }
     }
   }
 }
 
-bool Level::drawBombs(const Player& player)
+const std::vector<EdgeRemap>& Level::getEdgeRemaps() const
+{
+  return edgeRemaps;
+}
+
+int Level::getTileMapGeneration() const
+{
+  return tileMapGeneration;
+}
+
+const std::vector<int>& Level::getToggledCells() const
+{
+  return toggledCells;
+}
+
+int Level::getBombSpawnCount() const
+{
+  return bombSpawnCount;
+}
+
+int Level::getBombDetonatedCount() const
+{
+  return bombDetonatedCount;
+}
+
+const BombField& Level::getBombField() const
 {
-  return bombField.drawBombs(edgeMap, player);
+  return bombField;
+}
+
+void Level::setAudio(GameAudio* audio)
+{
+  bombField.setAudio(audio);
+}
+
+void Level::setJobSystem(JobSystem* jobSystem)
+{
+  bombField.setJobSystem(jobSystem);
+}
+
+void Level::setBlastZoneBackend(BlastZoneBackend backend)
+{
+  blastZoneBackend = backend;
+}
+
+void Level::setBlastRadius(float blastRadius)
+{
+  this->blastRadius = blastRadius;
 }
 
 bool Level::updateBombs(float frameTime, const Player& player)
 {
-  bool bombDetonated = bombField.update(frameTime);
+  PROFILE_SCOPE("Level::updateBombs");
+  bool bombDetonated = bombField.update(frameTime, *this);
   timeSinceLastSpawn += frameTime;
   if (timeSinceLastSpawn > spawnDelay)
   {
-    if ((static_cast<float>(std::rand()) / RAND_MAX) < spawnProbability)
+    if (getRandomFloat() < spawnProbability)
     {
       spawnBombNextToPlayer(player);
       spawnProbability = MIN_SPAWN_PROBABILITY;
@@ -142,45 +249,105 @@ bool Level::updateBombs(float frameTime, const Player& player)
   return bombDetonated;
 }
 
+bool Level::checkPlayerHit(const Player& player)
+{
+  return bombField.checkPlayerHit(player);
+}
+
 void Level::createTileMap()
 { 
-  tileMap.clear();
-  tileMap.resize(tileCount);
-  for (std::size_t i = 0; i < tileMap.size(); i++)
+  resetTileMap();
+  for (int i = 0; i < tileCount; i++)
+  {
+    if (interiorCells.test(i) && !isBorderIndex(i) && getRandomFloat() < cellProbability)
+      occupancy.set(i);
+  }
+  rebuildEmptyCellIndex();
+  convertTileMapToEdgeMap();
+}
+
+// Leaves only the border filled
+void Level::resetTileMap()
+{
+  tileMapGeneration++;
+  toggledCells.clear();
+  tileMap.assign(tileCount, Cell());
+  occupancy.resize(tileCount);
+  interiorCells.resize(tileCount);
+  for (int i = 0; i < tileCount; i++)
   {
-    tileMap[i].setCoordinates(getCellX(i), getCellY(i));
     if (isOutOfBoundsIndex(i))
       continue;
+    interiorCells.set(i);
     if (isBorderIndex(i))
-      tileMap[i].place();
-    else if ((static_cast<float>(std::rand()) / RAND_MAX) < CELL_PROBABILITY)
-      tileMap[i].place();
+      occupancy.set(i);
+  }
+}
+
+// Replaces the tiles with a fixed layout. The border is always filled and the ring
+// outside it always empty, whatever the grid holds there.
+bool Level::loadTileMap(const OccupancyGrid& cells)
+{
+  if (cells.getSize() != static_cast<std::size_t>(tileCount))
+    return false;
+  bombField.clearBombField();
+  resetTileMap();
+  for (int i = 0; i < tileCount; i++)
+  {
+    if (interiorCells.test(i) && !isBorderIndex(i) && cells.test(i))
+      occupancy.set(i);
   }
+  rebuildEmptyCellIndex();
   convertTileMapToEdgeMap();
+  return true;
+}
+
+void Level::setCellProbability(float cellProbability)
+{
+  this->cellProbability = cellProbability;
 }
 
 void Level::convertTileMapToEdgeMap()
 {
+  PROFILE_SCOPE("Level::convertTileMapToEdgeMap");
   edgeMap.clear();
+  edgeDirections.clear();
+  edgeRemaps.clear();
+  edgeMapVersion++;
 
   for (std::size_t i = 0; i < tileMap.size(); i++)
     tileMap[i].clearAllEdges();
 
-  for (int x = 1; x < nTilesWidth - 1; x++)
+  // Cells are visited in index order, so the run a side extends (from the north or
+  // west neighbour) has always been built before the side itself
+  std::array<std::uint64_t, 4> edgeWords;
+  for (std::size_t word = 0; word < occupancy.getWordCount(); word++)
   {
-    for (int y = 1; y < nTilesHeight - 1; y++)
+    std::uint64_t cells = occupancy.getWord(word) & interiorCells.getWord(word);
+    if (cells == 0)
+      continue;
+
+    long long firstIndex = static_cast<long long>(word * OccupancyGrid::WORD_BITS);
+    for (Direction direction : ALL_DIRECTIONS)
+    {
+      long long neighborOffset = calculateNeighborIndex(direction, 0);
+      edgeWords[static_cast<int>(direction)] = cells & ~occupancy.getBits(firstIndex + neighborOffset);
+    }
+
+    std::uint64_t edgeCells = edgeWords[0] | edgeWords[1] | edgeWords[2] | edgeWords[3];
+    while (edgeCells != 0)
     {
-      int currentIndex = calculateCellIndex(x, y);
-      if (tileMap[currentIndex].exists())
+      int bit = OccupancyGrid::countTrailingZeros(edgeCells);
+      edgeCells &= edgeCells - 1;
+      for (Direction direction : ALL_DIRECTIONS)
       {
-        for (Direction direction : ALL_DIRECTIONS)
-        {
-          if (!tileMap[calculateNeighborIndex(direction, currentIndex)].exists())
-            addEdgeToMap(direction, currentIndex);
-        }       
+        if ((edgeWords[static_cast<int>(direction)] >> bit) & 1)
+          addEdgeToMap(direction, static_cast<int>(firstIndex + bit));
       }
     }
   }
+
+  rebuildChunks();
 }
 
 int Level::coordinateToCellIndex(int xPosition, int yPosition) const
@@ -270,97 +437,390 @@ int Level::calculateNeighborIndex(Direction direction, int currentIndex) const
 void Level::checkEdge(Direction direction, int currentIndex)
 {
   int indexOfTileInDirection = calculateNeighborIndex(direction, currentIndex); 
-  if (!tileMap[indexOfTileInDirection].exists())
+  if (!occupancy.test(indexOfTileInDirection))
   {
     addEdgeToMap(direction, currentIndex);
   }
 }
 
 void Level::addEdgeToMap(Direction direction, int cellIndex)
+{
+  int previousIndex = calculateNeighborIndex(getOppositeDirection(getRunDirection(direction)), cellIndex);
+  const Cell& previousNeighbor = tileMap[previousIndex];
+
+  if (previousNeighbor.edgeExists(direction))
+  {
+    Edge& edge = edgeMap[previousNeighbor.getEdgeID(direction)];
+    if (direction == Direction::WEST || direction == Direction::EAST)
+      edge.endY += tileSize;
+    else
+      edge.endX += tileSize;
+    tileMap[cellIndex].setEdgeID(direction, previousNeighbor.getEdgeID(direction));
+  }
+  else
+  {
+    int edgeID = edgeMap.size();
+    edgeMap.push_back(createEdgeSegment(direction, cellIndex));
+    edgeDirections.push_back(direction);
+
+    tileMap[cellIndex].setEdgeID(direction, edgeID);
+  }
+}
+
+Direction Level::getOppositeDirection(Direction direction) const
+{
+  switch (direction)
+  {
+    case Direction::NORTH:
+      return Direction::SOUTH;
+    case Direction::SOUTH:
+      return Direction::NORTH;
+    case Direction::EAST:
+      return Direction::WEST;
+    case Direction::WEST:
+      return Direction::EAST;
+    default:
+      std::cout << "Direction not valid!" << std::endl;
+      exit(EXIT_FAILURE);
+  }
+}
+
+Direction Level::getRunDirection(Direction direction) const
 {
   if (direction == Direction::WEST || direction == Direction::EAST)
+    return Direction::SOUTH;
+  else
+    return Direction::EAST;
+}
+
+Edge Level::createEdgeSegment(Direction direction, int cellIndex) const
+{
+  Edge edge;
+  edge.startX = getCellX(cellIndex);
+  edge.startY = getCellY(cellIndex);
+
+  if (direction == Direction::EAST)
+    edge.startX += tileSize;
+  else if (direction == Direction::SOUTH)
+    edge.startY += tileSize;
+
+  if (direction == Direction::WEST || direction == Direction::EAST)
+  {
+    edge.endX = edge.startX; edge.endY = edge.startY + tileSize;
+  }
+  else
+  {
+    edge.endX = edge.startX + tileSize; edge.endY = edge.startY;
+  }
+  return edge;
+}
+
+int Level::getEdgeLength(const Edge& edge) const
+{
+  return static_cast<int>((edge.endX - edge.startX + edge.endY - edge.startY) / tileSize);
+}
+
+void Level::updateEdgeSegment(Direction direction, int cellIndex)
+{
+  // Cells on the outer ring never carry edges, and their neighbours may lie off the map
+  if (cellIndex < 0 || cellIndex >= tileCount || isOutOfBoundsIndex(cellIndex))
+    return;
+
+  bool edgeNeeded = occupancy.test(cellIndex) && !occupancy.test(calculateNeighborIndex(direction, cellIndex));
+
+  if (edgeNeeded && !tileMap[cellIndex].edgeExists(direction))
+    insertEdgeSegment(direction, cellIndex);
+  else if (!edgeNeeded && tileMap[cellIndex].edgeExists(direction))
+    eraseEdgeSegment(direction, cellIndex);
+}
+
+void Level::insertEdgeSegment(Direction direction, int cellIndex)
+{
+  Direction runDirection = getRunDirection(direction);
+  const Cell& previousNeighbor = tileMap[calculateNeighborIndex(getOppositeDirection(runDirection), cellIndex)];
+  const Cell& nextNeighbor = tileMap[calculateNeighborIndex(runDirection, cellIndex)];
+  Edge segment = createEdgeSegment(direction, cellIndex);
+  int edgeID;
+
+  if (previousNeighbor.edgeExists(direction) && nextNeighbor.edgeExists(direction))
   {
-    int northIndex = calculateNeighborIndex(Direction::NORTH, cellIndex);
-    Cell northernNeighbor = tileMap[northIndex];
+    int previousID = previousNeighbor.getEdgeID(direction);
+    int nextID = nextNeighbor.getEdgeID(direction);
+    const Edge& previousEdge = edgeMap[previousID];
+    const Edge& nextEdge = edgeMap[nextID];
+    Edge mergedEdge = { previousEdge.startX, previousEdge.startY, nextEdge.endX, nextEdge.endY };
+
+    // Keep the longer run's ID so only the shorter run's cells need relabelling
+    int absorbedID = nextID;
+    edgeID = previousID;
+    if (getEdgeLength(nextEdge) > getEdgeLength(previousEdge))
+    {
+      absorbedID = previousID;
+      edgeID = nextID;
+    }
+
+    relabelEdgeCells(edgeMap[absorbedID], direction, edgeID);
+    resizeEdge(edgeID, mergedEdge);
+    destroyEdge(absorbedID);
+    if (edgeID == static_cast<int>(edgeMap.size()))
+      edgeID = absorbedID;
+  }
+  else if (previousNeighbor.edgeExists(direction))
+  {
+    edgeID = previousNeighbor.getEdgeID(direction);
+    const Edge& edge = edgeMap[edgeID];
+    resizeEdge(edgeID, { edge.startX, edge.startY, segment.endX, segment.endY });
+  }
+  else if (nextNeighbor.edgeExists(direction))
+  {
+    edgeID = nextNeighbor.getEdgeID(direction);
+    const Edge& edge = edgeMap[edgeID];
+    resizeEdge(edgeID, { segment.startX, segment.startY, edge.endX, edge.endY });
+  }
+  else
+  {
+    edgeID = createEdge(segment, direction);
+  }
+
+  tileMap[cellIndex].setEdgeID(direction, edgeID);
+}
+
+void Level::eraseEdgeSegment(Direction direction, int cellIndex)
+{
+  Direction runDirection = getRunDirection(direction);
+  const Cell& previousNeighbor = tileMap[calculateNeighborIndex(getOppositeDirection(runDirection), cellIndex)];
+  const Cell& nextNeighbor = tileMap[calculateNeighborIndex(runDirection, cellIndex)];
+  Edge segment = createEdgeSegment(direction, cellIndex);
+  int edgeID = tileMap[cellIndex].getEdgeID(direction);
+  Edge edge = edgeMap[edgeID];
+
+  tileMap[cellIndex].removeEdge(direction);
 
-    if (northernNeighbor.edgeExists(direction))
+  Edge headEdge = { edge.startX, edge.startY, segment.startX, segment.startY };
+  Edge tailEdge = { segment.endX, segment.endY, edge.endX, edge.endY };
+
+  if (previousNeighbor.edgeExists(direction) && nextNeighbor.edgeExists(direction))
+  {
+    // Split off the shorter half under a new ID so fewer cells need relabelling
+    if (getEdgeLength(headEdge) >= getEdgeLength(tailEdge))
     {
-      edgeMap[northernNeighbor.getEdgeID(direction)].endY += tileSize;
-      tileMap[cellIndex].addEdge(direction);
-      tileMap[cellIndex].setEdgeID(direction, northernNeighbor.getEdgeID(direction));      
+      resizeEdge(edgeID, headEdge);
+      relabelEdgeCells(tailEdge, direction, createEdge(tailEdge, direction));
     }
     else
     {
-      Edge newEdge;
+      resizeEdge(edgeID, tailEdge);
+      relabelEdgeCells(headEdge, direction, createEdge(headEdge, direction));
+    }
+  }
+  else if (previousNeighbor.edgeExists(direction))
+  {
+    resizeEdge(edgeID, headEdge);
+  }
+  else if (nextNeighbor.edgeExists(direction))
+  {
+    resizeEdge(edgeID, tailEdge);
+  }
+  else
+  {
+    destroyEdge(edgeID);
+  }
+}
 
-      if (direction == Direction::WEST)
-      {
-        newEdge.startX = tileMap[cellIndex].getX();
-      }
-      else if (direction == Direction::EAST)
-      {
-        newEdge.startX = tileMap[cellIndex].getX() + tileSize;
-      }
+int Level::createEdge(const Edge& edge, Direction direction)
+{
+  int edgeID = edgeMap.size();
+  edgeMap.push_back(edge);
+  edgeDirections.push_back(direction);
+  addEdgeToChunks(edgeID, edge);
+  edgeRemaps.push_back({ -1, edgeID });
+  return edgeID;
+}
+
+void Level::resizeEdge(int edgeID, const Edge& edge)
+{
+  removeEdgeFromChunks(edgeID, edgeMap[edgeID]);
+  edgeMap[edgeID] = edge;
+  addEdgeToChunks(edgeID, edge);
+  edgeRemaps.push_back({ edgeID, edgeID });
+}
 
-      newEdge.startY = tileMap[cellIndex].getY();
-      newEdge.endX = newEdge.startX; newEdge.endY = newEdge.startY + tileSize; 
-      
-      int edgeID = edgeMap.size();
-      edgeMap.push_back(newEdge);
+void Level::destroyEdge(int edgeID)
+{
+  int lastID = edgeMap.size() - 1;
+  removeEdgeFromChunks(edgeID, edgeMap[edgeID]);
+  edgeRemaps.push_back({ edgeID, -1 });
 
-      tileMap[cellIndex].addEdge(direction);
-      tileMap[cellIndex].setEdgeID(direction, edgeID);   
-    }
+  // Keep the edge list dense by moving the last edge into the freed ID
+  if (edgeID != lastID)
+  {
+    edgeMap[edgeID] = edgeMap[lastID];
+    edgeDirections[edgeID] = edgeDirections[lastID];
+    renameEdgeInChunks(lastID, edgeID, edgeMap[edgeID]);
+    relabelEdgeCells(edgeMap[edgeID], edgeDirections[edgeID], edgeID);
+    edgeRemaps.push_back({ lastID, edgeID });
   }
-  else if (direction == Direction::NORTH || direction == Direction::SOUTH)
+
+  edgeMap.pop_back();
+  edgeDirections.pop_back();
+}
+
+void Level::relabelEdgeCells(const Edge& edge, Direction direction, int edgeID)
+{
+  int cellIndex = coordinateToCellIndex(static_cast<int>(edge.startX), static_cast<int>(edge.startY));
+  if (direction == Direction::EAST)
+    cellIndex = calculateNeighborIndex(Direction::WEST, cellIndex);
+  else if (direction == Direction::SOUTH)
+    cellIndex = calculateNeighborIndex(Direction::NORTH, cellIndex);
+
+  Direction runDirection = getRunDirection(direction);
+  for (int i = 0; i < getEdgeLength(edge); i++)
   {
-    int westIndex = calculateNeighborIndex(Direction::WEST, cellIndex);
-    Cell westernNeighbor = tileMap[westIndex];
-    
-    if (westernNeighbor.edgeExists(direction))
+    tileMap[cellIndex].setEdgeID(direction, edgeID);
+    cellIndex = calculateNeighborIndex(runDirection, cellIndex);
+  }
+}
+
+void Level::rebuildChunks()
+{
+  for (LevelChunk& chunk : chunks)
+  {
+    chunk.edgeIDs.clear();
+    chunk.cornerIDs.clear();
+  }
+  std::fill(cornerRefCounts.begin(), cornerRefCounts.end(), 0);
+  for (std::size_t i = 0; i < edgeMap.size(); i++)
+  {
+    addCorner(getCornerID(edgeMap[i].startX, edgeMap[i].startY));
+    addCorner(getCornerID(edgeMap[i].endX, edgeMap[i].endY));
+    ChunkRange range = getEdgeChunkRange(edgeMap[i]);
+    for (int row = range.firstRow; row <= range.lastRow; row++)
     {
-      edgeMap[westernNeighbor.getEdgeID(direction)].endX += tileSize;
-      tileMap[cellIndex].addEdge(direction);
-      tileMap[cellIndex].setEdgeID(direction, westernNeighbor.getEdgeID(direction));
+      for (int column = range.firstColumn; column <= range.lastColumn; column++)
+        chunks[row * nChunksWidth + column].edgeIDs.push_back(i);
     }
-    else
+  }
+
+  std::vector<Edge> chunkEdges;
+  for (LevelChunk& chunk : chunks)
+  {
+    chunkEdges.clear();
+    for (int edgeID : chunk.edgeIDs)
+      chunkEdges.push_back(edgeMap[edgeID]);
+    chunk.edgeArrays.assign(chunkEdges);
+  }
+}
+
+ChunkRange Level::getEdgeChunkRange(const Edge& edge) const
+{
+  return getChunkRange(std::min(edge.startX, edge.endX), std::min(edge.startY, edge.endY),
+    std::max(edge.startX, edge.endX), std::max(edge.startY, edge.endY));
+}
+
+void Level::addEdgeToChunks(int edgeID, const Edge& edge)
+{
+  addCorner(getCornerID(edge.startX, edge.startY));
+  addCorner(getCornerID(edge.endX, edge.endY));
+  ChunkRange range = getEdgeChunkRange(edge);
+  for (int row = range.firstRow; row <= range.lastRow; row++)
+  {
+    for (int column = range.firstColumn; column <= range.lastColumn; column++)
     {
-      Edge newEdge;
+      LevelChunk& chunk = chunks[row * nChunksWidth + column];
+      chunk.edgeArrays.addEdge(chunk.edgeIDs.size(), edge);
+      chunk.edgeIDs.push_back(edgeID);
+    }
+  }
+}
 
-      if (direction == Direction::NORTH)
-      {
-        newEdge.startY = tileMap[cellIndex].getY();
-      }
-      else if (direction == Direction::SOUTH) 
+void Level::removeEdgeFromChunks(int edgeID, const Edge& edge)
+{
+  removeCorner(getCornerID(edge.startX, edge.startY));
+  removeCorner(getCornerID(edge.endX, edge.endY));
+  ChunkRange range = getEdgeChunkRange(edge);
+  for (int row = range.firstRow; row <= range.lastRow; row++)
+  {
+    for (int column = range.firstColumn; column <= range.lastColumn; column++)
+    {
+      // Same swap-remove as the level's own edge list, one level down
+      LevelChunk& chunk = chunks[row * nChunksWidth + column];
+      int position = std::find(chunk.edgeIDs.begin(), chunk.edgeIDs.end(), edgeID) - chunk.edgeIDs.begin();
+      int lastPosition = chunk.edgeIDs.size() - 1;
+      chunk.edgeArrays.removeEdge(position);
+      if (position != lastPosition)
       {
-        newEdge.startY = tileMap[cellIndex].getY() + tileSize;
+        chunk.edgeArrays.renameEdge(lastPosition, position);
+        chunk.edgeIDs[position] = chunk.edgeIDs[lastPosition];
       }
+      chunk.edgeIDs.pop_back();
+    }
+  }
+}
 
-      newEdge.startX = tileMap[cellIndex].getX();
-      newEdge.endX = newEdge.startX + tileSize; newEdge.endY = newEdge.startY;
-
-      int edgeID = edgeMap.size();
-      edgeMap.push_back(newEdge);
-
-      tileMap[cellIndex].addEdge(direction);
-      tileMap[cellIndex].setEdgeID(direction, edgeID); 
+void Level::renameEdgeInChunks(int oldEdgeID, int newEdgeID, const Edge& edge)
+{
+  ChunkRange range = getEdgeChunkRange(edge);
+  for (int row = range.firstRow; row <= range.lastRow; row++)
+  {
+    for (int column = range.firstColumn; column <= range.lastColumn; column++)
+    {
+      LevelChunk& chunk = chunks[row * nChunksWidth + column];
+      *std::find(chunk.edgeIDs.begin(), chunk.edgeIDs.end(), oldEdgeID) = newEdgeID;
     }
   }
 }
 
+int Level::getCornerID(float x, float y) const
+{
+  return (static_cast<int>(y) / tileSize) * (nTilesWidth + 1) + static_cast<int>(x) / tileSize;
+}
+
+// Merged edges meet end to end at corners, so most corners are shared. Counting the
+// edge ends at each one lists it once, however many edges end there.
+void Level::addCorner(int cornerID)
+{
+  if (cornerRefCounts[cornerID]++ != 0)
+    return;
+  int column = cornerID % (nTilesWidth + 1);
+  int row = cornerID / (nTilesWidth + 1);
+  ChunkRange range = getChunkRange(column * tileSize, row * tileSize, column * tileSize, row * tileSize);
+  LevelChunk& chunk = chunks[range.firstRow * nChunksWidth + range.firstColumn];
+  cornerPositions[cornerID] = chunk.cornerIDs.size();
+  chunk.cornerIDs.push_back(cornerID);
+}
+
+void Level::removeCorner(int cornerID)
+{
+  if (--cornerRefCounts[cornerID] != 0)
+    return;
+  int column = cornerID % (nTilesWidth + 1);
+  int row = cornerID / (nTilesWidth + 1);
+  ChunkRange range = getChunkRange(column * tileSize, row * tileSize, column * tileSize, row * tileSize);
+  LevelChunk& chunk = chunks[range.firstRow * nChunksWidth + range.firstColumn];
+  int position = cornerPositions[cornerID];
+  chunk.cornerIDs[position] = chunk.cornerIDs.back();
+  cornerPositions[chunk.cornerIDs[position]] = position;
+  chunk.cornerIDs.pop_back();
+}
+
+bool Level::cellExistsAtCell(int column, int row) const
+{
+  if (column < 0 || column >= nTilesWidth || row < 0 || row >= nTilesHeight)
+    return false;
+  return occupancy.test(calculateCellIndex(column, row));
+}
+
 void Level::spawnRandomBomb()
 {
-  std::vector<int> emptyCellIndices = getEmptyCellIndices();
-  int randomIndex = emptyCellIndices[std::rand() % emptyCellIndices.size()];
+  int randomIndex = getRandomEmptyCellIndex();
   int cellPositionX = getCellX(randomIndex);
   int cellPositionY = getCellY(randomIndex);
-  int randomOffsetX = std::rand() % (tileSize - 10) + 5;
-  int randomOffsetY = std::rand() % (tileSize - 10) + 5;
+  int randomOffsetX = getRandomInt(tileSize - 10) + 5;
+  int randomOffsetY = getRandomInt(tileSize - 10) + 5;
   int randomPositionX = cellPositionX + randomOffsetX;
   int randomPositionY = cellPositionY + randomOffsetY;
 
-  Bomb* newBomb = new Bomb(randomPositionX, randomPositionY, 1.5f, 3.0f);
-  addBombToMap(newBomb);
+  addBombToMap(randomPositionX, randomPositionY);
 }
 
 void Level::spawnBombNextToPlayer(const Player& player)
@@ -369,28 +829,56 @@ void Level::spawnBombNextToPlayer(const Player& player)
   int playerPositionY = static_cast<int>(player.getPositionY());
   int cellPositionX = getCellX(playerPositionX, playerPositionY);
   int cellPositionY = getCellY(playerPositionX, playerPositionY);
-  int randomOffsetX = std::rand() % (tileSize - 10) + 5;
-  int randomOffsetY = std::rand() % (tileSize - 10) + 5;
+  int randomOffsetX = getRandomInt(tileSize - 10) + 5;
+  int randomOffsetY = getRandomInt(tileSize - 10) + 5;
   int randomPositionX = cellPositionX + randomOffsetX;
   int randomPositionY = cellPositionY + randomOffsetY;
 
-  Bomb* newBomb = new Bomb(randomPositionX, randomPositionY, 1.5f, 3.0f);
-  addBombToMap(newBomb);
+  addBombToMap(randomPositionX, randomPositionY);
 }
 
-std::vector<int> Level::getEmptyCellIndices() const
+void Level::rebuildEmptyCellIndex()
 {
-  std::vector<int> emptyCellIndices(tileMap.size());
-  std::size_t last = 0;
-  for (std::size_t i = 0; i < tileMap.size(); i++)
+  emptyCellIndices.clear();
+  emptyCellPositions.assign(tileCount, -1);
+  for (std::size_t word = 0; word < occupancy.getWordCount(); word++)
   {
-    if (!tileMap[i].exists() && !isOutOfBoundsIndex(i))
+    std::uint64_t emptyCells = ~occupancy.getWord(word) & interiorCells.getWord(word);
+    while (emptyCells != 0)
     {
-      emptyCellIndices[last++] = i;
+      int cellIndex = word * OccupancyGrid::WORD_BITS + OccupancyGrid::countTrailingZeros(emptyCells);
+      emptyCellPositions[cellIndex] = emptyCellIndices.size();
+      emptyCellIndices.push_back(cellIndex);
+      emptyCells &= emptyCells - 1;
     }
   }
-  emptyCellIndices.erase(emptyCellIndices.begin() + last, emptyCellIndices.end());
-  return emptyCellIndices;
+}
+
+void Level::updateEmptyCellIndex(int cellIndex)
+{
+  if (!interiorCells.test(cellIndex))
+    return;
+
+  bool isEmpty = !occupancy.test(cellIndex);
+  int position = emptyCellPositions[cellIndex];
+  if (isEmpty && position == -1)
+  {
+    emptyCellPositions[cellIndex] = emptyCellIndices.size();
+    emptyCellIndices.push_back(cellIndex);
+  }
+  else if (!isEmpty && position != -1)
+  {
+    int lastCellIndex = emptyCellIndices.back();
+    emptyCellIndices[position] = lastCellIndex;
+    emptyCellPositions[lastCellIndex] = position;
+    emptyCellIndices.pop_back();
+    emptyCellPositions[cellIndex] = -1;
+  }
+}
+
+int Level::getRandomEmptyCellIndex()
+{
+  return emptyCellIndices[getRandomInt(emptyCellIndices.size())];
 }
 
 void Level::updateSpawnDelay()
@@ -403,12 +891,11 @@ void Level::updateSpawnProbability()
   spawnProbability = spawnProbability < (MAX_SPAWN_PROBABILITY - SPAWN_PROBABILITY_UPDATE) ? spawnProbability + SPAWN_PROBABILITY_UPDATE : MAX_SPAWN_PROBABILITY;
 }
 
-std::pair<float, float> Level::getSpawnLocation(float playerWidth) const
+std::pair<float, float> Level::getSpawnLocation(float playerWidth)
 {
-  std::vector<int> emptyCellIndices = getEmptyCellIndices();
-  int randomSpawnIndex = std::rand() % static_cast<int>(emptyCellIndices.size());
-  int cellPositionX = getCellX(emptyCellIndices[randomSpawnIndex]);
-  int cellPositionY = getCellY(emptyCellIndices[randomSpawnIndex]);
+  int spawnIndex = getRandomEmptyCellIndex();
+  int cellPositionX = getCellX(spawnIndex);
+  int cellPositionY = getCellY(spawnIndex);
   float offset = (tileSize - playerWidth) / 2.0f;
   return std::pair<float, float>(cellPositionX + offset, cellPositionY + offset);
 }
@@ -422,4 +909,14 @@ void Level::generateNewLevel()
   spawnProbability = MIN_SPAWN_PROBABILITY;
   bombField.clearBombField();
   createTileMap();
+}
+
+int Level::getRandomInt(int upperBound)
+{
+  return random.nextInt(upperBound);
+}
+
+float Level::getRandomFloat()
+{
+  return random.nextFloat();
 }
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "OccupancyGrid.h"
+#include <vector>
+#include <cstdint>
+
+OccupancyGrid::OccupancyGrid()
+  : size(0)
+{
+}
+
+void OccupancyGrid::resize(std::size_t size)
+{
+  this->size = size;
+  words.assign((size + WORD_BITS - 1) / WORD_BITS, 0);
+}
+
+void OccupancyGrid::clear()
+{
+  words.assign(words.size(), 0);
+}
+
+std::size_t OccupancyGrid::getSize() const
+{
+  return size;
+}
+
+std::size_t OccupancyGrid::getWordCount() const
+{
+  return words.size();
+}
+
+bool OccupancyGrid::test(int index) const
+{
+  return (words[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+}
+
+void OccupancyGrid::set(int index)
+{
+  words[index / WORD_BITS] |= std::uint64_t(1) << (index % WORD_BITS);
+}
+
+void OccupancyGrid::reset(int index)
+{
+  words[index / WORD_BITS] &= ~(std::uint64_t(1) << (index % WORD_BITS));
+}
+
+void OccupancyGrid::flip(int index)
+{
+  words[index / WORD_BITS] ^= std::uint64_t(1) << (index % WORD_BITS);
+}
+
+void OccupancyGrid::setRange(int firstIndex, int lastIndex)
+{
+  if (firstIndex > lastIndex)
+    return;
+
+  std::size_t firstWord = firstIndex / WORD_BITS;
+  std::size_t lastWord = lastIndex / WORD_BITS;
+  std::uint64_t firstMask = ~std::uint64_t(0) << (firstIndex % WORD_BITS);
+  std::uint64_t lastMask = ~std::uint64_t(0) >> (WORD_BITS - 1 - lastIndex % WORD_BITS);
+
+  if (firstWord == lastWord)
+  {
+    words[firstWord] |= firstMask & lastMask;
+    return;
+  }
+  words[firstWord] |= firstMask;
+  for (std::size_t word = firstWord + 1; word < lastWord; word++)
+    words[word] = ~std::uint64_t(0);
+  words[lastWord] |= lastMask;
+}
+
+std::uint64_t OccupancyGrid::getWord(std::size_t wordIndex) const
+{
+  return words[wordIndex];
+}
+
+std::uint64_t OccupancyGrid::getBits(long long firstIndex) const
+{
+  // 64 bits starting at any index, so a neighbour offset of a whole word can be read in one go.
+  // Bits outside the grid read as empty.
+  long long wordCount = static_cast<long long>(words.size());
+  long long wordIndex = firstIndex >= 0 ? firstIndex / static_cast<long long>(WORD_BITS) : (firstIndex - static_cast<long long>(WORD_BITS) + 1) / static_cast<long long>(WORD_BITS);
+  int shift = static_cast<int>(firstIndex - wordIndex * static_cast<long long>(WORD_BITS));
+
+  std::uint64_t low = wordIndex >= 0 && wordIndex < wordCount ? words[wordIndex] : 0;
+  if (shift == 0)
+    return low;
+  std::uint64_t high = wordIndex + 1 >= 0 && wordIndex + 1 < wordCount ? words[wordIndex + 1] : 0;
+  return (low >> shift) | (high << (WORD_BITS - shift));
+}
+
+std::size_t OccupancyGrid::count() const
+{
+  std::size_t total = 0;
+  for (std::uint64_t word : words)
+    total += countBits(word);
+  return total;
+}
+
+int OccupancyGrid::countTrailingZeros(std::uint64_t word)
+{
+  return __builtin_ctzll(word);
+}
+
+int OccupancyGrid::countBits(std::uint64_t word)
+{
+  return __builtin_popcountll(word);
+}
\ No newline at end of file
@@ -1,15 +1,14 @@
-#include "raylib.h"
 #include "Player.h"
 #include "Direction.h"
 #include "Level.h"
 #include "Edge.h"
+#include "PlayerInput.h"
+#include "Profiler.h"
 #include <array>
-#include <string>
 
 Player::Player(float velocity, float xPosition, float yPosition)
-  : color(BLACK), velocity(velocity), xPosition(xPosition), yPosition(yPosition)
+  : velocity(velocity), xPosition(xPosition), yPosition(yPosition)
 {
-  playerSprite = LoadTexture(PLAYER_SPRITE_PATH.c_str());
   spriteDirection = Direction::WEST;
 }
 
@@ -28,8 +27,14 @@ float Player::getWidth() const
   return PLAYER_SPRITE_WIDTH;
 }
 
+Direction Player::getSpriteDirection() const
+{
+  return spriteDirection;
+}
+
 void Player::move(Direction direction, float frameTime, const Level& level)
 {
+  PROFILE_SCOPE("Player::move");
   switch (direction)
   {
     case Direction::NORTH:
@@ -77,20 +82,16 @@ void Player::move(Direction direction, float frameTime, const Level& level)
   }
 }
 
-void Player::draw() const
-{
-  if (spriteDirection == Direction::WEST)
-    DrawTextureRec(playerSprite, { 0, 0, static_cast<float>(PLAYER_SPRITE_WIDTH), static_cast<float>(PLAYER_SPRITE_WIDTH) }, { xPosition, yPosition }, RAYWHITE);
-  else
-    DrawTextureRec(playerSprite, { static_cast<float>(PLAYER_SPRITE_WIDTH), 0, static_cast<float>(PLAYER_SPRITE_WIDTH), static_cast<float>(PLAYER_SPRITE_WIDTH) }, { xPosition, yPosition }, RAYWHITE);
-}
-
-void Player::drawLoss(float alpha) const
+void Player::applyInput(const PlayerInput& input, float frameTime, const Level& level)
 {
-  if (spriteDirection == Direction::WEST)
-    DrawTextureRec(playerSprite, { 0, 0, static_cast<float>(PLAYER_SPRITE_WIDTH), static_cast<float>(PLAYER_SPRITE_WIDTH) }, { xPosition, yPosition }, Fade(RAYWHITE, alpha));
-  else
-    DrawTextureRec(playerSprite, { static_cast<float>(PLAYER_SPRITE_WIDTH), 0, static_cast<float>(PLAYER_SPRITE_WIDTH), static_cast<float>(PLAYER_SPRITE_WIDTH) }, { xPosition, yPosition }, Fade(RAYWHITE, alpha));
+  if (input.north)
+    move(Direction::NORTH, frameTime, level);
+  if (input.west)
+    move(Direction::WEST, frameTime, level);
+  if (input.south)
+    move(Direction::SOUTH, frameTime, level);
+  if (input.east)
+    move(Direction::EAST, frameTime, level);
 }
 
 void Player::resetPlayer(float xPosition, float yPosition)
@@ -0,0 +1,164 @@
+#include "Profiler.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <cstddef>
+#include <cstdint>
+
+namespace
+{
+  struct TraceEvent
+  {
+    const char* name;
+    std::uint64_t start;
+    std::uint64_t duration;
+    std::int64_t value;
+    bool counter;
+  };
+
+  const std::size_t EVENTS_PER_CHUNK = 4096;
+  const std::size_t MAX_CHUNKS = 1024;
+
+  // Only the owning thread writes. Chunks never move once allocated, and the event
+  // count is published with release ordering, so a dump can read [0, count) at any time.
+  // Events past MAX_CHUNKS * EVENTS_PER_CHUNK are dropped.
+  struct ThreadBuffer
+  {
+    std::atomic<const char*> threadName;
+    int threadIndex;
+    std::unique_ptr<std::atomic<TraceEvent*>[]> chunks;
+    std::atomic<std::size_t> eventCount;
+
+    explicit ThreadBuffer(int threadIndex)
+      : threadName(nullptr), threadIndex(threadIndex), chunks(new std::atomic<TraceEvent*>[MAX_CHUNKS]), eventCount(0)
+    {
+      for (std::size_t i = 0; i < MAX_CHUNKS; i++)
+        chunks[i] = nullptr;
+    }
+
+    ~ThreadBuffer()
+    {
+      for (std::size_t i = 0; i < MAX_CHUNKS; i++)
+        delete[] chunks[i].load();
+    }
+
+    void append(const TraceEvent& event)
+    {
+      std::size_t count = eventCount.load(std::memory_order_relaxed);
+      std::size_t chunk = count / EVENTS_PER_CHUNK;
+      if (chunk >= MAX_CHUNKS)
+        return;
+      TraceEvent* events = chunks[chunk].load(std::memory_order_relaxed);
+      if (!events)
+      {
+        events = new TraceEvent[EVENTS_PER_CHUNK];
+        chunks[chunk].store(events, std::memory_order_release);
+      }
+      events[count % EVENTS_PER_CHUNK] = event;
+      eventCount.store(count + 1, std::memory_order_release);
+    }
+  };
+
+  // Buffers outlive their threads so a dump at exit still sees workers that have finished
+  struct Registry
+  {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+  };
+
+  Registry& getRegistry()
+  {
+    static Registry registry;
+    return registry;
+  }
+
+  const std::chrono::steady_clock::time_point profileEpoch = std::chrono::steady_clock::now();
+
+  ThreadBuffer& getThreadBuffer()
+  {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer)
+    {
+      Registry& registry = getRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      registry.buffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer(static_cast<int>(registry.buffers.size()))));
+      buffer = registry.buffers.back().get();
+    }
+    return *buffer;
+  }
+
+  void writeEscaped(std::ofstream& file, const char* text)
+  {
+    for (; *text; text++)
+    {
+      if (*text == '"' || *text == '\\')
+        file << '\\';
+      file << *text;
+    }
+  }
+}
+
+void Profiler::setThreadName(const char* name)
+{
+  getThreadBuffer().threadName.store(name, std::memory_order_release);
+}
+
+void Profiler::recordScope(const char* name, std::uint64_t start, std::uint64_t end)
+{
+  getThreadBuffer().append({ name, start, end - start, 0, false });
+}
+
+void Profiler::recordCounter(const char* name, std::int64_t value)
+{
+  getThreadBuffer().append({ name, now(), 0, value, true });
+}
+
+std::uint64_t Profiler::now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - profileEpoch).count();
+}
+
+bool Profiler::writeChromeTrace(const std::string& path)
+{
+  std::ofstream file(path);
+  if (!file)
+    return false;
+
+  Registry& registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+  bool first = true;
+  for (const std::unique_ptr<ThreadBuffer>& buffer : registry.buffers)
+  {
+    const char* threadName = buffer->threadName.load(std::memory_order_acquire);
+    if (threadName)
+    {
+      file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadIndex << ",\"args\":{\"name\":\"";
+      writeEscaped(file, threadName);
+      file << "\"}}";
+      first = false;
+    }
+
+    std::size_t count = buffer->eventCount.load(std::memory_order_acquire);
+    for (std::size_t i = 0; i < count; i++)
+    {
+      const TraceEvent& event = buffer->chunks[i / EVENTS_PER_CHUNK].load(std::memory_order_acquire)[i % EVENTS_PER_CHUNK];
+      file << (first ? "" : ",\n") << "{\"name\":\"";
+      writeEscaped(file, event.name);
+      // Trace timestamps are in microseconds
+      file << "\",\"pid\":1,\"tid\":" << buffer->threadIndex << ",\"ts\":" << event.start / 1000.0;
+      if (event.counter)
+        file << ",\"ph\":\"C\",\"args\":{\"value\":" << event.value << "}}";
+      else
+        file << ",\"ph\":\"X\",\"dur\":" << event.duration / 1000.0 << "}";
+      first = false;
+    }
+  }
+  file << "\n]}\n";
+  return static_cast<bool>(file);
+}
\ No newline at end of file
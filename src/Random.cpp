@@ -0,0 +1,135 @@
+#include "Random.h"
+#include <array>
+#include <string>
+#include <cstdint>
+
+namespace
+{
+  std::uint64_t splitMix64(std::uint64_t& state)
+  {
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+}
+
+RandomStream::RandomStream()
+{
+  seed(0);
+}
+
+RandomStream::RandomStream(std::uint64_t seedValue)
+{
+  seed(seedValue);
+}
+
+void RandomStream::seed(std::uint64_t seedValue)
+{
+  // SplitMix64 expands the seed so that nearby seeds still give unrelated states
+  for (std::uint64_t& word : state)
+    word = splitMix64(seedValue);
+}
+
+std::uint64_t RandomStream::next()
+{
+  std::uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+  std::uint64_t t = state[1] << 17;
+  state[2] ^= state[0];
+  state[3] ^= state[1];
+  state[1] ^= state[2];
+  state[0] ^= state[3];
+  state[2] ^= t;
+  state[3] = rotateLeft(state[3], 45);
+  return result;
+}
+
+int RandomStream::nextInt(int upperBound)
+{
+  // Lemire's multiply-shift with rejection, unbiased for any bound in [1, 2^31)
+  std::uint32_t range = static_cast<std::uint32_t>(upperBound);
+  std::uint64_t product = (next() >> 32) * range;
+  std::uint32_t low = static_cast<std::uint32_t>(product);
+  if (low < range)
+  {
+    std::uint32_t threshold = (0u - range) % range;
+    while (low < threshold)
+    {
+      product = (next() >> 32) * range;
+      low = static_cast<std::uint32_t>(product);
+    }
+  }
+  return static_cast<int>(product >> 32);
+}
+
+float RandomStream::nextFloat()
+{
+  return (next() >> 40) * (1.0f / 16777216.0f);
+}
+
+float RandomStream::nextSignedFloat()
+{
+  return 2.0f * nextFloat() - 1.0f;
+}
+
+void RandomStream::jump()
+{
+  // Advances the stream by 2^128 steps, giving non-overlapping substreams
+  static const std::uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+
+  std::array<std::uint64_t, 4> jumped = { 0, 0, 0, 0 };
+  for (std::uint64_t word : JUMP)
+  {
+    for (int bit = 0; bit < 64; bit++)
+    {
+      if (word & (std::uint64_t(1) << bit))
+      {
+        for (int i = 0; i < 4; i++)
+          jumped[i] ^= state[i];
+      }
+      next();
+    }
+  }
+  state = jumped;
+}
+
+std::uint64_t RandomStream::rotateLeft(std::uint64_t value, int shift)
+{
+  return (value << shift) | (value >> (64 - shift));
+}
+
+RandomService::RandomService(std::uint64_t masterSeed)
+  : masterSeed(masterSeed)
+{
+}
+
+std::uint64_t RandomService::getMasterSeed() const
+{
+  return masterSeed;
+}
+
+RandomStream RandomService::getStream(const std::string& name) const
+{
+  std::uint64_t seedState = masterSeed ^ hashName(name);
+  return RandomStream(splitMix64(seedState));
+}
+
+RandomStream RandomService::getStream(const std::string& name, int threadIndex) const
+{
+  RandomStream stream = getStream(name);
+  for (int i = 0; i < threadIndex; i++)
+    stream.jump();
+  return stream;
+}
+
+std::uint64_t RandomService::hashName(const std::string& name)
+{
+  // FNV-1a
+  std::uint64_t hash = 0xcbf29ce484222325ULL;
+  for (char character : name)
+  {
+    hash ^= static_cast<unsigned char>(character);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
\ No newline at end of file
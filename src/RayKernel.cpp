@@ -0,0 +1,139 @@
+#include "RayKernel.h"
+#include "EdgeArrays.h"
+#include <cmath>
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RAY_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+RayKernelTarget RayKernel::target = RayKernel::detectTarget();
+
+float RayKernel::findClosestHit(const EdgeArrays& edgeArrays, float ray_startX, float ray_startY, float ray_dx, float ray_dy)
+{
+  // Returns the smallest ray parameter t1 >= 0 at which the ray crosses an edge, or INFINITY
+  float min_t1 = INFINITY;
+  min_t1 = findClosestHit(edgeArrays.getVerticalEdges(), ray_startX, ray_startY, 1.0f / ray_dx, ray_dy, min_t1);
+  min_t1 = findClosestHit(edgeArrays.getHorizontalEdges(), ray_startY, ray_startX, 1.0f / ray_dy, ray_dx, min_t1);
+  return min_t1;
+}
+
+RayKernelTarget RayKernel::getTarget()
+{
+  return target;
+}
+
+void RayKernel::setTarget(RayKernelTarget target)
+{
+  RayKernel::target = std::min(target, detectTarget());
+}
+
+RayKernelTarget RayKernel::detectTarget()
+{
+#ifdef RAY_KERNEL_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return RayKernelTarget::AVX2;
+  if (__builtin_cpu_supports("sse2"))
+    return RayKernelTarget::SSE;
+#endif
+  return RayKernelTarget::SCALAR;
+}
+
+float RayKernel::findClosestHit(const AxisAlignedEdges& edges, float originAlong, float originAcross, float inverseDirectionAlong, float directionAcross, float min_t1)
+{
+  switch (target)
+  {
+    case RayKernelTarget::AVX2:
+      return findClosestHitAVX2(edges, originAlong, originAcross, inverseDirectionAlong, directionAcross, min_t1);
+    case RayKernelTarget::SSE:
+      return findClosestHitSSE(edges, originAlong, originAcross, inverseDirectionAlong, directionAcross, min_t1);
+    default:
+      return findClosestHitScalar(edges, originAlong, originAcross, inverseDirectionAlong, directionAcross, min_t1);
+  }
+}
+
+// Every edge is axis-aligned, so the ray parameter at the edge's line is a single multiply by the
+// precomputed inverse ray direction, and the hit only has to land between the edge's endpoints.
+float RayKernel::findClosestHitScalar(const AxisAlignedEdges& edges, float originAlong, float originAcross, float inverseDirectionAlong, float directionAcross, float min_t1)
+{
+  for (std::size_t i = 0; i < edges.count; i++)
+  {
+    float t1 = (edges.position[i] - originAlong) * inverseDirectionAlong;
+    float across = originAcross + directionAcross * t1;
+    if (t1 >= 0 && t1 < min_t1 && across >= edges.start[i] && across <= edges.end[i])
+      min_t1 = t1;
+  }
+  return min_t1;
+}
+
+#ifdef RAY_KERNEL_X86
+
+float RayKernel::findClosestHitSSE(const AxisAlignedEdges& edges, float originAlong, float originAcross, float inverseDirectionAlong, float directionAcross, float min_t1)
+{
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 infinity = _mm_set1_ps(INFINITY);
+  const __m128 origin_along = _mm_set1_ps(originAlong);
+  const __m128 origin_across = _mm_set1_ps(originAcross);
+  const __m128 inverse_along = _mm_set1_ps(inverseDirectionAlong);
+  const __m128 direction_across = _mm_set1_ps(directionAcross);
+  __m128 min_t1_lanes = _mm_set1_ps(min_t1);
+
+  for (std::size_t i = 0; i < edges.count; i += 4)
+  {
+    __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&edges.position[i]), origin_along), inverse_along);
+    __m128 across = _mm_add_ps(origin_across, _mm_mul_ps(direction_across, t1));
+    __m128 hit = _mm_and_ps(
+      _mm_cmpge_ps(t1, zero),
+      _mm_and_ps(_mm_cmpge_ps(across, _mm_loadu_ps(&edges.start[i])), _mm_cmple_ps(across, _mm_loadu_ps(&edges.end[i])))
+    );
+    min_t1_lanes = _mm_min_ps(min_t1_lanes, _mm_or_ps(_mm_and_ps(hit, t1), _mm_andnot_ps(hit, infinity)));
+  }
+
+  min_t1_lanes = _mm_min_ps(min_t1_lanes, _mm_shuffle_ps(min_t1_lanes, min_t1_lanes, _MM_SHUFFLE(2, 3, 0, 1)));
+  min_t1_lanes = _mm_min_ps(min_t1_lanes, _mm_shuffle_ps(min_t1_lanes, min_t1_lanes, _MM_SHUFFLE(1, 0, 3, 2)));
+  return _mm_cvtss_f32(min_t1_lanes);
+}
+
+__attribute__((target("avx2")))
+float RayKernel::findClosestHitAVX2(const AxisAlignedEdges& edges, float originAlong, float originAcross, float inverseDirectionAlong, float directionAcross, float min_t1)
+{
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 infinity = _mm256_set1_ps(INFINITY);
+  const __m256 origin_along = _mm256_set1_ps(originAlong);
+  const __m256 origin_across = _mm256_set1_ps(originAcross);
+  const __m256 inverse_along = _mm256_set1_ps(inverseDirectionAlong);
+  const __m256 direction_across = _mm256_set1_ps(directionAcross);
+  __m256 min_t1_lanes = _mm256_set1_ps(min_t1);
+
+  for (std::size_t i = 0; i < edges.count; i += 8)
+  {
+    __m256 t1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(&edges.position[i]), origin_along), inverse_along);
+    __m256 across = _mm256_add_ps(origin_across, _mm256_mul_ps(direction_across, t1));
+    __m256 hit = _mm256_and_ps(
+      _mm256_cmp_ps(t1, zero, _CMP_GE_OQ),
+      _mm256_and_ps(_mm256_cmp_ps(across, _mm256_loadu_ps(&edges.start[i]), _CMP_GE_OQ), _mm256_cmp_ps(across, _mm256_loadu_ps(&edges.end[i]), _CMP_LE_OQ))
+    );
+    min_t1_lanes = _mm256_min_ps(min_t1_lanes, _mm256_blendv_ps(infinity, t1, hit));
+  }
+
+  __m128 min_t1_half = _mm_min_ps(_mm256_castps256_ps128(min_t1_lanes), _mm256_extractf128_ps(min_t1_lanes, 1));
+  min_t1_half = _mm_min_ps(min_t1_half, _mm_shuffle_ps(min_t1_half, min_t1_half, _MM_SHUFFLE(2, 3, 0, 1)));
+  min_t1_half = _mm_min_ps(min_t1_half, _mm_shuffle_ps(min_t1_half, min_t1_half, _MM_SHUFFLE(1, 0, 3, 2)));
+  return _mm_cvtss_f32(min_t1_half);
+}
+
+#else
+
+float RayKernel::findClosestHitSSE(const AxisAlignedEdges& edges, float originAlong, float originAcross, float inverseDirectionAlong, float directionAcross, float min_t1)
+{
+  return findClosestHitScalar(edges, originAlong, originAcross, inverseDirectionAlong, directionAcross, min_t1);
+}
+
+float RayKernel::findClosestHitAVX2(const AxisAlignedEdges& edges, float originAlong, float originAcross, float inverseDirectionAlong, float directionAcross, float min_t1)
+{
+  return findClosestHitScalar(edges, originAlong, originAcross, inverseDirectionAlong, directionAcross, min_t1);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,24 @@
+#include "raylib.h"
+#include "RaylibAudio.h"
+
+RaylibAudio::RaylibAudio()
+{
+  explosionSound = LoadSound(EXPLOSION_SOUND_PATH.c_str());
+  beepSound = LoadSound(BEEP_SOUND_PATH.c_str());
+}
+
+RaylibAudio::~RaylibAudio()
+{
+  UnloadSound(explosionSound);
+  UnloadSound(beepSound);
+}
+
+void RaylibAudio::playBeepSound()
+{
+  PlaySound(beepSound);
+}
+
+void RaylibAudio::playExplosionSound()
+{
+  PlaySound(explosionSound);
+}
\ No newline at end of file
@@ -1,10 +1,10 @@
 #include "raylib.h"
 #include "ShakyCam.h"
-#include <cstdlib>
+#include "Random.h"
 #include <cmath>
 
-ShakyCam::ShakyCam(Vector2 offset, Vector2 target, float rotation, float zoom)
-  : trauma(0.0f)
+ShakyCam::ShakyCam(Vector2 offset, Vector2 target, float rotation, float zoom, RandomStream random)
+  : trauma(0.0f), random(random)
 {
   baseCam = { offset, target, rotation, zoom };
   shakyCam = { offset, target, rotation, zoom };
@@ -21,9 +21,9 @@ void ShakyCam::update(float frameTime)
 
 void ShakyCam::shakeCamera()
 {
-  float randomRotation = 2.5 * std::pow(trauma, 2) * (2 * ((float) std::rand() / RAND_MAX) - 1);
-  float randomXOffset = 1 * std::pow(trauma, 2) * (2 * ((float) std::rand() / RAND_MAX) - 1);
-  float randomYOffset = 1 * std::pow(trauma, 2) * (2 * ((float) std::rand() / RAND_MAX) - 1);
+  float randomRotation = 2.5 * std::pow(trauma, 2) * random.nextSignedFloat();
+  float randomXOffset = 1 * std::pow(trauma, 2) * random.nextSignedFloat();
+  float randomYOffset = 1 * std::pow(trauma, 2) * random.nextSignedFloat();
   shakyCam.rotation = baseCam.rotation + randomRotation;
   shakyCam.target = { baseCam.target.x + randomXOffset, baseCam.target.y + randomYOffset };
 }
@@ -38,6 +38,12 @@ void ShakyCam::addTrauma(float traumaAmount)
   trauma += traumaAmount; 
 }
 
+// The shake is applied around the target on the next update
+void ShakyCam::setTarget(Vector2 target)
+{
+  baseCam.target = target;
+}
+
 const Camera2D& ShakyCam::getShakyCam() const
 {
   return shakyCam;
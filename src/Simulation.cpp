@@ -0,0 +1,95 @@
+#include "Simulation.h"
+#include "Level.h"
+#include "Player.h"
+#include "PlayerInput.h"
+#include "Random.h"
+#include <utility>
+
+Simulation::Simulation(int nTilesWidth, int nTilesHeight, int tileSize, const RandomService& random)
+  : level(nTilesWidth, nTilesHeight, tileSize, random.getStream("level")), player(PLAYER_VELOCITY, 0, 0)
+{
+  startGame();
+}
+
+void Simulation::step(const PlayerInput& input, float frameTime)
+{
+  if (!gameLost)
+  {
+    player.applyInput(input, frameTime, level);
+    survivalTime += frameTime;
+  }
+
+  bombDetonated = level.updateBombs(frameTime, player);
+
+  if (level.checkPlayerHit(player) && !gameLost)
+  {
+    gameLost = true;
+    bombsSurvived = level.getBombDetonatedCount() - 1;
+  }
+}
+
+void Simulation::reset()
+{
+  level.generateNewLevel();
+  startGame();
+}
+
+void Simulation::startGame()
+{
+  std::pair<float, float> spawnLocation = level.getSpawnLocation(PLAYER_WIDTH);
+  player.resetPlayer(spawnLocation.first, spawnLocation.second);
+  gameLost = false;
+  bombDetonated = false;
+  bombsSurvived = -1;
+  survivalTime = 0.0f;
+}
+
+void Simulation::setAudio(GameAudio* audio)
+{
+  level.setAudio(audio);
+}
+
+void Simulation::setJobSystem(JobSystem* jobSystem)
+{
+  level.setJobSystem(jobSystem);
+}
+
+void Simulation::setBlastZoneBackend(BlastZoneBackend backend)
+{
+  level.setBlastZoneBackend(backend);
+}
+
+void Simulation::setBlastRadius(float blastRadius)
+{
+  level.setBlastRadius(blastRadius);
+}
+
+bool Simulation::isGameLost() const
+{
+  return gameLost;
+}
+
+bool Simulation::isBombDetonated() const
+{
+  return bombDetonated;
+}
+
+int Simulation::getBombsSurvived() const
+{
+  return bombsSurvived;
+}
+
+float Simulation::getSurvivalTime() const
+{
+  return survivalTime;
+}
+
+const Level& Simulation::getLevel() const
+{
+  return level;
+}
+
+const Player& Simulation::getPlayer() const
+{
+  return player;
+}
\ No newline at end of file
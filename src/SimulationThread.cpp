@@ -0,0 +1,220 @@
+#include "SimulationThread.h"
+#include "Simulation.h"
+#include "SimulationSnapshot.h"
+#include "Level.h"
+#include "Bomb.h"
+#include "BombField.h"
+#include "Player.h"
+#include "PlayerInput.h"
+#include "InputLog.h"
+#include "Profiler.h"
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+
+SimulationThread::SimulationThread(Simulation& simulation, float tickSeconds)
+  : simulation(simulation), tickSeconds(tickSeconds), recording(nullptr), replay(nullptr), replayFrame(0),
+  tickCount(0), gameIndex(0), detonationCount(0), running(false), replayFinished(false), restartRequested(false),
+  inputMask(0), latestStepSeconds(tickSeconds), snapshotPool(std::make_shared<SnapshotPool>())
+{
+  simulation.setAudio(&audio);
+  publishSnapshot(tickSeconds);
+  publishSnapshot(tickSeconds);
+}
+
+SimulationThread::~SimulationThread()
+{
+  stop();
+}
+
+void SimulationThread::setRecording(InputLog* inputLog)
+{
+  recording = inputLog;
+}
+
+void SimulationThread::setReplay(const InputLog* inputLog)
+{
+  replay = inputLog;
+  replayFrame = 0;
+  replayFinished = replay != nullptr && replay->getFrameCount() == 0;
+}
+
+void SimulationThread::start()
+{
+  if (running)
+    return;
+  running = true;
+  thread = std::thread(&SimulationThread::run, this);
+}
+
+void SimulationThread::stop()
+{
+  running = false;
+  if (thread.joinable())
+    thread.join();
+}
+
+void SimulationThread::setInput(const PlayerInput& input)
+{
+  inputMask = InputLog::encodeInput(input);
+}
+
+void SimulationThread::requestRestart()
+{
+  restartRequested = true;
+}
+
+bool SimulationThread::isReplayFinished() const
+{
+  return replayFinished;
+}
+
+// Returns how far the render time has moved from the previous snapshot towards the latest one
+float SimulationThread::getSnapshots(std::shared_ptr<const SimulationSnapshot>& previous, std::shared_ptr<const SimulationSnapshot>& latest) const
+{
+  std::lock_guard<std::mutex> lock(snapshotMutex);
+  previous = previousSnapshot;
+  latest = latestSnapshot;
+  float elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - latestPublishTime).count();
+  return std::min(elapsed / latestStepSeconds, 1.0f);
+}
+
+void SimulationThread::run()
+{
+  PROFILE_THREAD_NAME("simulation");
+  typedef std::chrono::steady_clock Clock;
+  const Clock::duration tick = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(tickSeconds));
+  Clock::time_point nextTick = Clock::now() + tick;
+
+  while (running && !replayFinished)
+  {
+    std::this_thread::sleep_until(nextTick);
+
+    // After a stall, drop the backlog instead of fast-forwarding through it
+    Clock::time_point now = Clock::now();
+    int ticks = 0;
+    while (nextTick <= now && ticks < MAX_CATCH_UP_TICKS && !replayFinished)
+    {
+      publishSnapshot(stepSimulation());
+      nextTick += tick;
+      ticks++;
+    }
+    if (nextTick <= now)
+      nextTick = now + tick;
+  }
+}
+
+float SimulationThread::stepSimulation()
+{
+  PROFILE_SCOPE("SimulationThread::stepSimulation");
+  PlayerInput input = InputLog::decodeInput(inputMask);
+  bool restart = restartRequested.exchange(false) && simulation.isGameLost();
+  float frameTime = tickSeconds;
+  if (replay != nullptr)
+  {
+    input = replay->getInput(replayFrame);
+    restart = replay->isRestart(replayFrame);
+    frameTime = replay->getFrameTime(replayFrame);
+    replayFrame++;
+    if (replayFrame == replay->getFrameCount())
+      replayFinished = true;
+  }
+  if (recording != nullptr)
+    recording->recordFrame(input, restart, frameTime);
+
+  if (restart && simulation.isGameLost())
+  {
+    simulation.reset();
+    gameIndex++;
+  }
+  simulation.step(input, frameTime);
+  if (simulation.isBombDetonated())
+    detonationCount++;
+  tickCount++;
+  return frameTime;
+}
+
+void SimulationThread::publishSnapshot(float stepSeconds)
+{
+  PROFILE_SCOPE("SimulationThread::publishSnapshot");
+  // Reuse a snapshot the renderer has let go of, so bomb and fan buffers keep their capacity
+  std::unique_ptr<SimulationSnapshot> reused;
+  {
+    std::lock_guard<std::mutex> lock(snapshotPool->mutex);
+    reused = std::move(snapshotPool->spare);
+  }
+  if (!reused)
+    reused.reset(new SimulationSnapshot());
+  std::shared_ptr<SnapshotPool> pool = snapshotPool;
+  std::shared_ptr<SimulationSnapshot> snapshot(reused.release(), [pool](SimulationSnapshot* released)
+  {
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    if (!pool->spare)
+      pool->spare.reset(released);
+    else
+      delete released;
+  });
+
+  const Level& level = simulation.getLevel();
+  const Player& player = simulation.getPlayer();
+  captureTiles();
+  snapshot->tick = tickCount;
+  snapshot->gameIndex = gameIndex;
+  snapshot->playerX = player.getPositionX();
+  snapshot->playerY = player.getPositionY();
+  snapshot->playerDirection = player.getSpriteDirection();
+  snapshot->gameLost = simulation.isGameLost();
+  snapshot->bombsSurvived = simulation.getBombsSurvived();
+  snapshot->bombSpawnCount = level.getBombSpawnCount();
+  snapshot->detonationCount = detonationCount;
+  snapshot->beepCount = audio.getBeepCount();
+  snapshot->explosionCount = audio.getExplosionCount();
+  snapshot->tiles = tileSnapshot;
+
+  const BombField& bombField = level.getBombField();
+  std::size_t visibleBombs = 0;
+  for (std::size_t i = 0; i < bombField.getBombCount(); i++)
+  {
+    const Bomb& bomb = bombField.getBomb(i);
+    if (bomb.isBlastOver())
+      continue;
+    if (visibleBombs == snapshot->bombs.size())
+      snapshot->bombs.emplace_back();
+    BombSnapshot& bombSnapshot = snapshot->bombs[visibleBombs++];
+    bombSnapshot.xPosition = bomb.getXPosition();
+    bombSnapshot.yPosition = bomb.getYPosition();
+    bombSnapshot.blastStarted = bomb.isBlastStarted();
+    bombSnapshot.spriteTintRatio = bomb.getSpriteTintRatio();
+    bombSnapshot.blastAlpha = bomb.getBlastAlpha();
+    if (bomb.isBlastStarted())
+      bombSnapshot.triangleFan.assign(bomb.getBlastZone().getTriangleFan().begin(), bomb.getBlastZone().getTriangleFan().end());
+    else
+      bombSnapshot.triangleFan.clear();
+  }
+  snapshot->bombs.resize(visibleBombs);
+
+  std::lock_guard<std::mutex> lock(snapshotMutex);
+  previousSnapshot = std::move(latestSnapshot);
+  latestSnapshot = std::move(snapshot);
+  latestPublishTime = std::chrono::steady_clock::now();
+  latestStepSeconds = stepSeconds;
+}
+
+void SimulationThread::captureTiles()
+{
+  const Level& level = simulation.getLevel();
+  if (tileSnapshot && tileSnapshot->generation == level.getTileMapGeneration()
+    && tileSnapshot->toggledCells.size() == level.getToggledCells().size())
+    return;
+
+  std::shared_ptr<TileSnapshot> tiles = std::make_shared<TileSnapshot>();
+  tiles->nTilesWidth = level.getNumberOfTilesWidth();
+  tiles->nTilesHeight = level.getNumberOfTilesHeight();
+  tiles->tileSize = level.getTileSize();
+  tiles->chunkSize = Level::CHUNK_SIZE;
+  tiles->generation = level.getTileMapGeneration();
+  tiles->occupancy = level.getOccupancyGrid();
+  tiles->toggledCells = level.getToggledCells();
+  tileSnapshot = std::move(tiles);
+}
\ No newline at end of file
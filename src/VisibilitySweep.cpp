@@ -0,0 +1,188 @@
+#include "VisibilitySweep.h"
+#include "Edge.h"
+#include "BlastRay.h"
+#include "PseudoAngle.h"
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+VisibilitySweep::VisibilitySweep()
+  : originX(0), originY(0), sweepAngle(-2)
+{}
+
+void VisibilitySweep::computeVisibilityPolygon(float originX, float originY, ArrayView<Edge> edgeMap, std::vector<BlastRay>& polygonPoints)
+{
+  this->originX = originX;
+  this->originY = originY;
+  polygonPoints.clear();
+  addSegments(edgeMap);
+
+  std::sort(
+    events.begin(), events.end(),
+    [](const SweepEvent& e1, const SweepEvent& e2)
+    {
+      if (e1.angle != e2.angle)
+        return e1.angle < e2.angle;
+      return !e1.isStart && e2.isStart;
+    });
+
+  ActiveSegments activeSegments{SegmentOrder(this)};
+  activePositions.assign(segments.size(), activeSegments.end());
+  activeFlags.assign(segments.size(), false);
+
+  // Segments straddling the -x axis are already in view when the sweep starts at -pi,
+  // which is -2 in pseudo-angle
+  sweepAngle = -2;
+  for (std::size_t i = 0; i < segments.size(); i++)
+  {
+    if (segments[i].startAngle > segments[i].endAngle)
+      insertSegment(activeSegments, i);
+  }
+  addPolygonPoint(getNearestSegment(activeSegments), sweepAngle, polygonPoints);
+
+  std::size_t i = 0;
+  while (i < events.size())
+  {
+    sweepAngle = events[i].angle;
+    int nearestBefore = getNearestSegment(activeSegments);
+
+    for (; i < events.size() && events[i].angle == sweepAngle; i++)
+    {
+      if (events[i].isStart)
+        insertSegment(activeSegments, events[i].segment);
+      else
+        removeSegment(activeSegments, events[i].segment);
+    }
+
+    int nearestAfter = getNearestSegment(activeSegments);
+    if (nearestBefore != nearestAfter)
+    {
+      addPolygonPoint(nearestBefore, sweepAngle, polygonPoints);
+      addPolygonPoint(nearestAfter, sweepAngle, polygonPoints);
+    }
+  }
+
+  addPolygonPoint(getNearestSegment(activeSegments), 2, polygonPoints);
+}
+
+void VisibilitySweep::addSegments(ArrayView<Edge> edgeMap)
+{
+  segments.clear();
+  events.clear();
+
+  for (const Edge& edge : edgeMap)
+  {
+    SweepSegment segment = { edge.startX, edge.startY, edge.endX, edge.endY, 0, 0 };
+    double cross = (segment.startX - originX) * (segment.endY - originY) - (segment.startY - originY) * (segment.endX - originX);
+    if (cross == 0)
+      continue;
+    // Orient every segment so the sweep meets its start point first
+    if (cross < 0)
+    {
+      std::swap(segment.startX, segment.endX);
+      std::swap(segment.startY, segment.endY);
+    }
+    segment.startAngle = PseudoAngle::fromDirection(segment.startX - originX, segment.startY - originY);
+    segment.endAngle = PseudoAngle::fromDirection(segment.endX - originX, segment.endY - originY);
+
+    int segmentIndex = segments.size();
+    segments.push_back(segment);
+    events.push_back({ segment.startAngle, true, segmentIndex });
+    events.push_back({ segment.endAngle, false, segmentIndex });
+  }
+}
+
+void VisibilitySweep::insertSegment(ActiveSegments& activeSegments, int segment)
+{
+  if (activeFlags[segment])
+    return;
+  activePositions[segment] = activeSegments.insert(segment).first;
+  activeFlags[segment] = true;
+}
+
+void VisibilitySweep::removeSegment(ActiveSegments& activeSegments, int segment)
+{
+  if (!activeFlags[segment])
+    return;
+  activeSegments.erase(activePositions[segment]);
+  activeFlags[segment] = false;
+}
+
+int VisibilitySweep::getNearestSegment(const ActiveSegments& activeSegments) const
+{
+  return activeSegments.empty() ? -1 : *activeSegments.begin();
+}
+
+void VisibilitySweep::addPolygonPoint(int segment, double angle, std::vector<BlastRay>& polygonPoints) const
+{
+  if (segment < 0)
+    return;
+  double ray_dx, ray_dy;
+  PseudoAngle::toDirection(angle, ray_dx, ray_dy);
+  double distance = getDistanceAlongRay(segment, angle);
+  polygonPoints.push_back({
+    static_cast<float>(angle),
+    static_cast<float>(originX + distance * ray_dx),
+    static_cast<float>(originY + distance * ray_dy)
+  });
+}
+
+double VisibilitySweep::getDistanceAlongRay(int segment, double angle) const
+{
+  const SweepSegment& s = segments[segment];
+  double ray_dx, ray_dy;
+  PseudoAngle::toDirection(angle, ray_dx, ray_dy);
+  double segment_dx = s.endX - s.startX;
+  double segment_dy = s.endY - s.startY;
+  double denominator = ray_dx * segment_dy - ray_dy * segment_dx;
+  if (denominator == 0)
+    return std::hypot(s.startX - originX, s.startY - originY) / std::hypot(ray_dx, ray_dy);
+  return ((s.startX - originX) * segment_dy - (s.startY - originY) * segment_dx) / denominator;
+}
+
+// a is in front of b if b lies wholly on the far side of a's line, or a lies wholly on the near side
+// of b's line. Points are pulled in slightly from the ends so shared corners do not count as touching.
+bool VisibilitySweep::isSegmentInFront(int a, int b) const
+{
+  const SweepSegment& sa = segments[a];
+  const SweepSegment& sb = segments[b];
+
+  int originSideOfA = getSide(a, originX, originY);
+  int b1SideOfA = getSide(a, sb.startX + 0.01 * (sb.endX - sb.startX), sb.startY + 0.01 * (sb.endY - sb.startY));
+  int b2SideOfA = getSide(a, sb.endX + 0.01 * (sb.startX - sb.endX), sb.endY + 0.01 * (sb.startY - sb.endY));
+  if (b1SideOfA != 0 && b1SideOfA == b2SideOfA && b1SideOfA != originSideOfA)
+    return true;
+
+  int originSideOfB = getSide(b, originX, originY);
+  int a1SideOfB = getSide(b, sa.startX + 0.01 * (sa.endX - sa.startX), sa.startY + 0.01 * (sa.endY - sa.startY));
+  int a2SideOfB = getSide(b, sa.endX + 0.01 * (sa.startX - sa.endX), sa.endY + 0.01 * (sa.startY - sa.endY));
+  return a1SideOfB != 0 && a1SideOfB == a2SideOfB && a1SideOfB == originSideOfB;
+}
+
+int VisibilitySweep::getSide(int segment, double x, double y) const
+{
+  const SweepSegment& s = segments[segment];
+  double cross = (s.endX - s.startX) * (y - s.startY) - (s.endY - s.startY) * (x - s.startX);
+  return (cross > 0) - (cross < 0);
+}
+
+VisibilitySweep::SegmentOrder::SegmentOrder(const VisibilitySweep* sweep)
+  : sweep(sweep)
+{}
+
+bool VisibilitySweep::SegmentOrder::operator()(int a, int b) const
+{
+  if (a == b)
+    return false;
+  if (sweep->isSegmentInFront(a, b))
+    return true;
+  if (sweep->isSegmentInFront(b, a))
+    return false;
+  double distanceA = sweep->getDistanceAlongRay(a, sweep->sweepAngle);
+  double distanceB = sweep->getDistanceAlongRay(b, sweep->sweepAngle);
+  if (distanceA != distanceB)
+    return distanceA < distanceB;
+  return a < b;
+}
\ No newline at end of file
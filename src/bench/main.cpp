@@ -0,0 +1,335 @@
+#include "Level.h"
+#include "BlastZone.h"
+#include "BlastZoneBackend.h"
+#include "Player.h"
+#include "Direction.h"
+#include "OccupancyGrid.h"
+#include "Random.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+
+const int TILE_SIZE = 40;
+const int PLAYER_WIDTH = 20;
+const float PLAYER_VELOCITY = 100.0f;
+const float FRAME_TIME = 1.0f / 60.0f;
+const int MIN_ITERATIONS = 3;
+const int HIT_TEST_BATCH = 1000;
+const int PLAYER_MOVE_BATCH = 1000;
+
+// Keeps hit test results alive so the optimiser cannot drop the queries
+volatile int hitSink = 0;
+
+struct MapSize
+{
+  int width;
+  int height;
+};
+
+struct BenchOptions
+{
+  // The largest map holds 9 million tiles, to show blast cost stays flat as the world grows
+  std::vector<MapSize> sizes = { { 30, 20 }, { 100, 100 }, { 300, 300 }, { 1000, 1000 }, { 3000, 3000 } };
+  std::vector<float> densities = { 0.05f, 0.1f, 0.3f };
+  std::vector<std::string> layouts = { "random", "checkerboard", "corridors" };
+  std::vector<float> radii = { 200.0f, 1000.0f };
+  double minSeconds = 0.2;
+  std::uint64_t seed = 1;
+  std::string outputPath;
+};
+
+struct BenchCase
+{
+  MapSize size;
+  std::string layout;
+  float density;
+  float blastRadius;
+};
+
+struct Timing
+{
+  int iterations;
+  double meanNanoseconds;
+  double medianNanoseconds;
+  double minNanoseconds;
+};
+
+bool parseOptions(int argc, char** argv, BenchOptions& options);
+bool buildLayout(const BenchCase& benchCase, std::uint64_t seed, Level& level);
+Timing measure(double minSeconds, int operationsPerIteration, const std::function<void()>& operation);
+void runCase(const BenchCase& benchCase, const BenchOptions& options, std::vector<std::string>& results);
+std::string formatCase(const std::string& benchmark, const BenchCase& benchCase, std::size_t edgeCount);
+std::string formatResult(const std::string& benchmark, const BenchCase& benchCase, std::size_t edgeCount, const Timing& timing);
+
+int main(int argc, char** argv)
+{
+  BenchOptions options;
+  if (!parseOptions(argc, argv, options))
+  {
+    std::cerr << "Usage: blastzone_bench [--sizes WxH,...] [--densities D,...] [--layouts random|checkerboard|corridors,...] [--radii R,...] [--min-time SECONDS] [--seed S] [--output FILE]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::string> results;
+  for (const MapSize& size : options.sizes)
+  {
+    for (const std::string& layout : options.layouts)
+    {
+      // Only the random layout depends on density
+      if (layout != "random")
+      {
+        runCase({ size, layout, 0.0f, 0.0f }, options, results);
+        continue;
+      }
+      for (float density : options.densities)
+        runCase({ size, layout, density, 0.0f }, options, results);
+    }
+  }
+
+  std::ofstream file;
+  if (!options.outputPath.empty())
+  {
+    file.open(options.outputPath);
+    if (!file)
+    {
+      std::cerr << "Could not write " << options.outputPath << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  std::ostream& output = options.outputPath.empty() ? std::cout : file;
+  output << "{\"seed\":" << options.seed << ",\"results\":[\n";
+  for (std::size_t i = 0; i < results.size(); i++)
+    output << "  " << results[i] << (i + 1 < results.size() ? ",\n" : "\n");
+  output << "]}" << std::endl;
+  return 0;
+}
+
+bool parseOptions(int argc, char** argv, BenchOptions& options)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    std::string argument = argv[i];
+    if (i + 1 >= argc)
+      return false;
+    std::stringstream values(argv[++i]);
+    std::string value;
+    if (argument == "--sizes")
+    {
+      options.sizes.clear();
+      while (std::getline(values, value, ','))
+      {
+        std::size_t separator = value.find('x');
+        if (separator == std::string::npos)
+          return false;
+        MapSize size = { std::atoi(value.substr(0, separator).c_str()), std::atoi(value.substr(separator + 1).c_str()) };
+        if (size.width < 5 || size.height < 5)
+          return false;
+        options.sizes.push_back(size);
+      }
+    }
+    else if (argument == "--densities")
+    {
+      options.densities.clear();
+      while (std::getline(values, value, ','))
+        options.densities.push_back(std::strtof(value.c_str(), nullptr));
+    }
+    else if (argument == "--layouts")
+    {
+      options.layouts.clear();
+      while (std::getline(values, value, ','))
+      {
+        if (value != "random" && value != "checkerboard" && value != "corridors")
+          return false;
+        options.layouts.push_back(value);
+      }
+    }
+    else if (argument == "--radii")
+    {
+      options.radii.clear();
+      while (std::getline(values, value, ','))
+      {
+        float radius = std::strtof(value.c_str(), nullptr);
+        if (radius <= 0.0f)
+          return false;
+        options.radii.push_back(radius);
+      }
+    }
+    else if (argument == "--min-time")
+      options.minSeconds = std::atof(values.str().c_str());
+    else if (argument == "--seed")
+      options.seed = std::strtoull(values.str().c_str(), nullptr, 10);
+    else if (argument == "--output")
+      options.outputPath = values.str();
+    else
+      return false;
+  }
+  return true;
+}
+
+// Random fills cells with the case's density. A checkerboard gives every filled cell its own
+// four edges, the worst case for edge count. Corridors are full-width walls on every other
+// row, each with a single gap, which gives long edges and long rays.
+bool buildLayout(const BenchCase& benchCase, std::uint64_t seed, Level& level)
+{
+  int width = benchCase.size.width;
+  int height = benchCase.size.height;
+  if (benchCase.layout == "random")
+  {
+    level.setCellProbability(benchCase.density);
+    level.generateNewLevel();
+    return true;
+  }
+
+  RandomStream random(seed);
+  OccupancyGrid cells;
+  cells.resize(width * height);
+  for (int row = 0; row < height; row++)
+  {
+    int gapColumn = 2 + random.nextInt(std::max(width - 4, 1));
+    for (int column = 0; column < width; column++)
+    {
+      bool filled = false;
+      if (benchCase.layout == "checkerboard")
+        filled = (row + column) % 2 == 0;
+      else if (benchCase.layout == "corridors")
+        filled = row % 2 == 1 && column != gapColumn;
+      if (filled)
+        cells.set(row * width + column);
+    }
+  }
+  return level.loadTileMap(cells);
+}
+
+Timing measure(double minSeconds, int operationsPerIteration, const std::function<void()>& operation)
+{
+  typedef std::chrono::steady_clock Clock;
+  std::vector<double> samples;
+  Clock::time_point start = Clock::now();
+  while (samples.size() < static_cast<std::size_t>(MIN_ITERATIONS)
+    || std::chrono::duration<double>(Clock::now() - start).count() < minSeconds)
+  {
+    Clock::time_point iterationStart = Clock::now();
+    operation();
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - iterationStart;
+    samples.push_back(elapsed.count() / operationsPerIteration);
+  }
+
+  Timing timing;
+  timing.iterations = static_cast<int>(samples.size());
+  double total = 0.0;
+  for (double sample : samples)
+    total += sample;
+  timing.meanNanoseconds = total / samples.size();
+  std::sort(samples.begin(), samples.end());
+  timing.medianNanoseconds = samples[samples.size() / 2];
+  timing.minNanoseconds = samples.front();
+  return timing;
+}
+
+void runCase(const BenchCase& benchCase, const BenchOptions& options, std::vector<std::string>& results)
+{
+  int width = benchCase.size.width;
+  int height = benchCase.size.height;
+  std::cerr << width << "x" << height << " " << benchCase.layout;
+  if (benchCase.layout == "random")
+    std::cerr << " " << benchCase.density;
+  std::cerr << std::endl;
+
+  Level level(width, height, TILE_SIZE, RandomStream(options.seed));
+  if (!buildLayout(benchCase, options.seed, level))
+  {
+    std::cerr << "Could not build the " << benchCase.layout << " layout at " << width << "x" << height << ", skipping" << std::endl;
+    return;
+  }
+  Timing timing = measure(options.minSeconds, 1, [&] { buildLayout(benchCase, options.seed, level); });
+  std::size_t edgeCount = level.getEdgeMap().size();
+  results.push_back(formatResult(benchCase.layout == "random" ? "Level::generateNewLevel" : "Level::loadTileMap", benchCase, edgeCount, timing));
+
+  timing = measure(options.minSeconds, 1000, [&]
+  {
+    for (int i = 0; i < 1000; i++)
+      level.getSpawnLocation(PLAYER_WIDTH);
+  });
+  results.push_back(formatResult("Level::getSpawnLocation", benchCase, edgeCount, timing));
+
+  std::pair<float, float> spawn = level.getSpawnLocation(PLAYER_WIDTH);
+  Player player(PLAYER_VELOCITY, spawn.first, spawn.second);
+  RandomStream moveRandom(options.seed);
+  timing = measure(options.minSeconds, PLAYER_MOVE_BATCH, [&]
+  {
+    for (int i = 0; i < PLAYER_MOVE_BATCH; i++)
+      player.move(static_cast<Direction>(moveRandom.nextInt(4)), FRAME_TIME, level);
+  });
+  results.push_back(formatResult("Player::move", benchCase, edgeCount, timing));
+
+  // Blasts go off in the middle of the map, where rays have the furthest to travel
+  float originX = (width / 2 + 0.5f) * TILE_SIZE;
+  float originY = (height / 2 + 0.5f) * TILE_SIZE;
+  const std::vector<std::pair<BlastZoneBackend, std::string>> backends = {
+    { BlastZoneBackend::EDGE_MAP, "BlastZone::updateBlastZone/edge" },
+    { BlastZoneBackend::TILE_GRID, "BlastZone::updateBlastZone/grid" },
+    { BlastZoneBackend::ANGULAR_SWEEP, "BlastZone::updateBlastZone/sweep" } };
+  for (float radius : options.radii)
+  {
+    BenchCase blastCase = benchCase;
+    blastCase.blastRadius = radius;
+    bool hitTestMeasured = false;
+    for (const auto& backend : backends)
+    {
+      BlastZone blastZone(0.0001f, radius, backend.first);
+      timing = measure(options.minSeconds, 1, [&]
+      {
+        blastZone.reset(backend.first, radius);
+        blastZone.updateBlastZone(originX, originY, level);
+      });
+      results.push_back(formatResult(backend.second, blastCase, edgeCount, timing));
+
+      // Coverage is built the same way whatever the backend, so one hit test run per radius is enough
+      if (!hitTestMeasured)
+      {
+        hitTestMeasured = true;
+        RandomStream hitRandom(options.seed);
+        Player target(PLAYER_VELOCITY, 0.0f, 0.0f);
+        timing = measure(options.minSeconds, HIT_TEST_BATCH, [&]
+        {
+          for (int i = 0; i < HIT_TEST_BATCH; i++)
+          {
+            target.resetPlayer(hitRandom.nextFloat() * (width - 1) * TILE_SIZE, hitRandom.nextFloat() * (height - 1) * TILE_SIZE);
+            hitSink = hitSink + blastZone.isPlayerInBlastZone(target);
+          }
+        });
+        results.push_back(formatResult("BlastZone::isPlayerInBlastZone", blastCase, edgeCount, timing));
+      }
+    }
+  }
+}
+
+std::string formatCase(const std::string& benchmark, const BenchCase& benchCase, std::size_t edgeCount)
+{
+  std::stringstream json;
+  json << "{\"benchmark\":\"" << benchmark << "\",\"width\":" << benchCase.size.width << ",\"height\":" << benchCase.size.height
+    << ",\"layout\":\"" << benchCase.layout << "\"";
+  if (benchCase.layout == "random")
+    json << ",\"density\":" << benchCase.density;
+  if (benchCase.blastRadius > 0.0f)
+    json << ",\"radius\":" << benchCase.blastRadius;
+  json << ",\"edges\":" << edgeCount;
+  return json.str();
+}
+
+std::string formatResult(const std::string& benchmark, const BenchCase& benchCase, std::size_t edgeCount, const Timing& timing)
+{
+  std::stringstream json;
+  json << formatCase(benchmark, benchCase, edgeCount) << std::fixed << std::setprecision(1)
+    << ",\"iterations\":" << timing.iterations << ",\"mean_ns\":" << timing.meanNanoseconds
+    << ",\"median_ns\":" << timing.medianNanoseconds << ",\"min_ns\":" << timing.minNanoseconds << "}";
+  return json.str();
+}
\ No newline at end of file
@@ -1,139 +1,263 @@
 #include "raylib.h"
-#include "Level.h"
-#include "Direction.h"
-#include "Player.h"
+#include "Simulation.h"
+#include "SimulationThread.h"
+#include "SimulationSnapshot.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "GameRenderer.h"
+#include "RaylibAudio.h"
+#include "PlayerInput.h"
 #include "ShakyCam.h"
+#include "Random.h"
+#include "InputLog.h"
 #include <string>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <iostream>
 #include <cstdlib>
+#include <cstdint>
 #include <ctime>
 #include <cmath>
-#include <utility>
 
 const int TILE_SIZE = 40;
 const int SCREEN_WIDTH = 30 * TILE_SIZE;
 const int SCREEN_HEIGHT = 20 * TILE_SIZE;
+const int PLAYER_WIDTH = 20;
 
 const Vector2 CAMERA_OFFSET = { SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 };
 const Vector2 CAMERA_TARGET = { SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2 };
 const float CAMERA_ROTATION = 0.0f;
 const float CAMERA_ZOOM = 1.0f;
 
-const float PLAYER_VELOCITY = 100.0f;
-const int PLAYER_WIDTH = 20.f;
+const float SIMULATION_TICK_SECONDS = 1.0f / 120.0f;
+const std::string TRACE_PATH = "blastzone_trace.json";
+
+struct GameOptions
+{
+  std::uint64_t seed = static_cast<std::uint64_t>(std::time(NULL));
+  int tilesWidth = SCREEN_WIDTH / TILE_SIZE;
+  int tilesHeight = SCREEN_HEIGHT / TILE_SIZE;
+  std::string recordPath;
+  std::string replayPath;
+};
 
-bool gameLost = false;
 float lossPlayerAlpha = 1.0f;
 float lossScreenAlpha = 1.0f;
-int bombsSurvived = -1;
 
-void updatePlayer(Player* player, float delta, const Level& level);
-bool drawGameState(Level* level, Player* player, bool gameLost, float lossPlayerAlpha);
-void drawLossScreen(int SCREEN_WIDTH, int SCREEN_HEIGHT, float lossPlayerAlpha);
-void resetGame(Level* level, Player* player);
+PlayerInput readPlayerInput();
+void playSnapshotAudio(RaylibAudio& audio, const SimulationSnapshot& previous, const SimulationSnapshot& latest);
+void drawGameState(const GameRenderer& renderer, const SimulationSnapshot& previous, const SimulationSnapshot& latest, float interpolation, float lossPlayerAlpha, Rectangle view);
+void drawLossScreen(int SCREEN_WIDTH, int SCREEN_HEIGHT, int bombsSurvived);
+Vector2 getCameraTarget(Vector2 playerPosition, const GameOptions& options);
+Rectangle getCameraView(const Camera2D& camera);
+void resetLossScreen();
+GameOptions parseOptions(int argc, char** argv);
+void writeTrace();
 
-int main(void)
+int main(int argc, char** argv)
 {
-  std::srand(std::time(NULL));
+  GameOptions options = parseOptions(argc, argv);
+  InputLog replay;
+  bool replaying = !options.replayPath.empty();
+  bool recording = !options.recordPath.empty();
+  if (replaying)
+  {
+    if (!replay.load(options.replayPath) || replay.getTileSize() != TILE_SIZE)
+    {
+      std::cerr << "Could not replay " << options.replayPath << std::endl;
+      return EXIT_FAILURE;
+    }
+    options.seed = replay.getSeed();
+    options.tilesWidth = replay.getNumberOfTilesWidth();
+    options.tilesHeight = replay.getNumberOfTilesHeight();
+  }
+
+  RandomService random(options.seed);
+  std::cout << "Seed: " << random.getMasterSeed() << std::endl;
+  InputLog inputLog(random.getMasterSeed(), options.tilesWidth, options.tilesHeight, TILE_SIZE);
 
   InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Level Editor");
   InitAudioDevice(); 
 
-  Level* level = new Level(SCREEN_WIDTH / TILE_SIZE, SCREEN_HEIGHT / TILE_SIZE, TILE_SIZE);
-  std::pair<float, float> spawnLocation = level->getSpawnLocation(PLAYER_WIDTH);
-  Player* player = new Player(PLAYER_VELOCITY, spawnLocation.first, spawnLocation.second);
-  ShakyCam camera(CAMERA_OFFSET, CAMERA_TARGET, CAMERA_ROTATION, CAMERA_ZOOM);
+  RaylibAudio* audio = new RaylibAudio();
+  GameRenderer* renderer = new GameRenderer();
+  Simulation* simulation = new Simulation(options.tilesWidth, options.tilesHeight, TILE_SIZE, random);
+  // The simulation thread joins in on its own jobs, and the main thread keeps a core for rendering
+  JobSystem* jobSystem = new JobSystem(std::max(static_cast<int>(std::thread::hardware_concurrency()) - 2, 0));
+  simulation->setJobSystem(jobSystem);
+  SimulationThread* simulationThread = new SimulationThread(*simulation, SIMULATION_TICK_SECONDS);
+  if (replaying)
+    simulationThread->setReplay(&replay);
+  if (recording)
+    simulationThread->setRecording(&inputLog);
+  ShakyCam camera(CAMERA_OFFSET, CAMERA_TARGET, CAMERA_ROTATION, CAMERA_ZOOM, random.getStream("camera"));
 
   SetTargetFPS(60);
+  PROFILE_THREAD_NAME("main");
+  simulationThread->start();
+
+  std::shared_ptr<const SimulationSnapshot> previous;
+  std::shared_ptr<const SimulationSnapshot> latest;
+  simulationThread->getSnapshots(previous, latest);
+  std::shared_ptr<const SimulationSnapshot> lastDrawn = latest;
 
-  while (!WindowShouldClose())
+  while (!WindowShouldClose() && !simulationThread->isReplayFinished())
   {
+    PROFILE_SCOPE("frame");
     float frameTime = GetFrameTime();
-    camera.update(frameTime);
+#ifdef BLASTZONE_PROFILING
+    if (IsKeyPressed(KEY_F9))
+      writeTrace();
+#endif
+
+    float interpolation = simulationThread->getSnapshots(previous, latest);
+    simulationThread->setInput(readPlayerInput());
 
-    if (!gameLost)
-      updatePlayer(player, frameTime, *level);
-    else
+    if (latest->gameLost)
     {
       lossPlayerAlpha = lossPlayerAlpha < frameTime ? 0.0f : lossPlayerAlpha - frameTime;
       if (lossPlayerAlpha == 0.0f)
         lossScreenAlpha = lossScreenAlpha < frameTime ? 0.0f : lossScreenAlpha - frameTime;
       if (IsKeyPressed(KEY_SPACE))
-      {
-        resetGame(level, player);
-      }
+        simulationThread->requestRestart();
     }
+    if (latest->gameIndex != lastDrawn->gameIndex)
+      resetLossScreen();
 
-    if (level->updateBombs(frameTime, *player))
+    playSnapshotAudio(*audio, *lastDrawn, *latest);
+    if (latest->detonationCount != lastDrawn->detonationCount)
       camera.addTrauma();
+    lastDrawn = latest;
+
+    camera.setTarget(getCameraTarget(GameRenderer::getPlayerPosition(*previous, *latest, interpolation), options));
+    camera.update(frameTime);
+    Rectangle view = getCameraView(camera.getShakyCam());
+    renderer->updateTileLayer(*latest->tiles, view);
 
     BeginDrawing();
     ClearBackground(GRAY);
     BeginMode2D(camera.getShakyCam());
 
-    gameLost = drawGameState(level, player, gameLost, lossPlayerAlpha);
-
-    DrawFPS(5, 10);
-    DrawText(("Bombs Spawned: " + std::to_string(level->getBombSpawnCount())).c_str(), SCREEN_WIDTH - 200, 10, 20, RAYWHITE);
+    drawGameState(*renderer, *previous, *latest, interpolation, lossPlayerAlpha, view);
 
     EndMode2D();
 
-    if (gameLost)
-    {
-      drawLossScreen(SCREEN_WIDTH, SCREEN_HEIGHT, lossPlayerAlpha);
-      if (bombsSurvived == -1)
-        bombsSurvived = level->getBombDetonatedCount() - 1;
-    }
+    DrawFPS(5, 10);
+    DrawText(("Bombs Spawned: " + std::to_string(latest->bombSpawnCount)).c_str(), SCREEN_WIDTH - 200, 10, 20, RAYWHITE);
+
+    if (latest->gameLost)
+      drawLossScreen(SCREEN_WIDTH, SCREEN_HEIGHT, latest->bombsSurvived);
 
     EndDrawing();
   }
 
+  simulationThread->stop();
+#ifdef BLASTZONE_PROFILING
+  writeTrace();
+#endif
+  if (recording)
+  {
+    const Player& player = simulation->getPlayer();
+    inputLog.setFinalState({ player.getPositionX(), player.getPositionY(), simulation->getLevel().getBombSpawnCount() });
+    if (!inputLog.save(options.recordPath))
+      std::cerr << "Could not write " << options.recordPath << std::endl;
+  }
+
+  delete simulationThread;
+  delete simulation;
+  delete jobSystem;
+  delete renderer;
+  delete audio;
   CloseAudioDevice();
   CloseWindow();
-  delete level;
-  delete player;
   return 0;
 }
 
-void updatePlayer(Player* player, float delta, const Level& level)
+PlayerInput readPlayerInput()
 {
-  if (IsKeyDown(KEY_W))
-    player->move(Direction::NORTH, delta, level);
-  if (IsKeyDown(KEY_A))
-    player->move(Direction::WEST, delta, level);
-  if (IsKeyDown(KEY_S))
-    player->move(Direction::SOUTH, delta, level);
-  if (IsKeyDown(KEY_D))
-    player->move(Direction::EAST, delta, level);
+  return { IsKeyDown(KEY_W), IsKeyDown(KEY_S), IsKeyDown(KEY_D), IsKeyDown(KEY_A) };
 }
 
-bool drawGameState(Level* level, Player* player, bool gameLost, float lossPlayerAlpha)
+// Sound counts are running totals, so events in snapshots the renderer skipped are not lost
+void playSnapshotAudio(RaylibAudio& audio, const SimulationSnapshot& previous, const SimulationSnapshot& latest)
 {
-  level->drawMap();
-  if (!gameLost)
-    player->draw();
-  else
-    player->drawLoss(lossPlayerAlpha);
+  if (latest.beepCount != previous.beepCount)
+    audio.playBeepSound();
+  if (latest.explosionCount != previous.explosionCount)
+    audio.playExplosionSound();
+}
 
-  if (level->drawBombs(*player))
-    return gameLost ? gameLost : !gameLost;
+void drawGameState(const GameRenderer& renderer, const SimulationSnapshot& previous, const SimulationSnapshot& latest, float interpolation, float lossPlayerAlpha, Rectangle view)
+{
+  renderer.drawLevel();
+  if (!latest.gameLost)
+    renderer.drawPlayer(previous, latest, interpolation);
   else
-    return gameLost;
+    renderer.drawPlayer(previous, latest, interpolation, lossPlayerAlpha);
+  renderer.drawBombs(latest, view);
 }
 
-void drawLossScreen(int SCREEN_WIDTH, int SCREEN_HEIGHT, float lossPlayerAlpha)
+void drawLossScreen(int SCREEN_WIDTH, int SCREEN_HEIGHT, int bombsSurvived)
 {
   float screenAlpha = std::pow((1.0f - lossScreenAlpha), 3) / 2.0f;
   DrawRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, Fade(BLACK, screenAlpha));
   DrawText(("Bombs Survived: " + std::to_string(bombsSurvived)).c_str(), (SCREEN_WIDTH / 2) - 225, (SCREEN_HEIGHT / 2) - 50, 50, Fade(RAYWHITE, 1.0f - lossScreenAlpha));
 }
 
-void resetGame(Level* level, Player* player)
+// Follows the player, but stops at the level's edges. A level smaller than the
+// screen stays centred.
+Vector2 getCameraTarget(Vector2 playerPosition, const GameOptions& options)
+{
+  float levelWidth = static_cast<float>(options.tilesWidth * TILE_SIZE);
+  float levelHeight = static_cast<float>(options.tilesHeight * TILE_SIZE);
+  float halfViewWidth = CAMERA_OFFSET.x / CAMERA_ZOOM;
+  float halfViewHeight = CAMERA_OFFSET.y / CAMERA_ZOOM;
+  Vector2 target = { playerPosition.x + PLAYER_WIDTH / 2, playerPosition.y + PLAYER_WIDTH / 2 };
+  target.x = levelWidth <= 2 * halfViewWidth ? levelWidth / 2 : std::min(std::max(target.x, halfViewWidth), levelWidth - halfViewWidth);
+  target.y = levelHeight <= 2 * halfViewHeight ? levelHeight / 2 : std::min(std::max(target.y, halfViewHeight), levelHeight - halfViewHeight);
+  return target;
+}
+
+// The world area on screen, padded by a tile so camera shake never uncovers an undrawn chunk
+Rectangle getCameraView(const Camera2D& camera)
+{
+  float width = SCREEN_WIDTH / camera.zoom;
+  float height = SCREEN_HEIGHT / camera.zoom;
+  return { camera.target.x - camera.offset.x / camera.zoom - TILE_SIZE, camera.target.y - camera.offset.y / camera.zoom - TILE_SIZE,
+    width + 2 * TILE_SIZE, height + 2 * TILE_SIZE };
+}
+
+void resetLossScreen()
 {
-  level->generateNewLevel();
-  std::pair<float, float> spawnLocation = level->getSpawnLocation(PLAYER_WIDTH);
-  player->resetPlayer(spawnLocation.first, spawnLocation.second);
-  gameLost = false;
   lossPlayerAlpha = 1.0f;
   lossScreenAlpha = 1.0f;
-  bombsSurvived = -1;
+}
+
+GameOptions parseOptions(int argc, char** argv)
+{
+  GameOptions options;
+  for (int i = 1; i < argc - 1; i++)
+  {
+    std::string argument = argv[i];
+    if (argument == "--seed")
+      options.seed = std::strtoull(argv[++i], nullptr, 10);
+    else if (argument == "--record")
+      options.recordPath = argv[++i];
+    else if (argument == "--replay")
+      options.replayPath = argv[++i];
+    else if (argument == "--width")
+      options.tilesWidth = std::max(std::atoi(argv[++i]), 5);
+    else if (argument == "--height")
+      options.tilesHeight = std::max(std::atoi(argv[++i]), 5);
+  }
+  return options;
+}
+
+void writeTrace()
+{
+  if (Profiler::writeChromeTrace(TRACE_PATH))
+    std::cout << "Trace written to " << TRACE_PATH << std::endl;
+  else
+    std::cerr << "Could not write " << TRACE_PATH << std::endl;
 }
\ No newline at end of file
@@ -0,0 +1,207 @@
+#include "Simulation.h"
+#include "PlayerInput.h"
+#include "BlastZoneBackend.h"
+#include "Random.h"
+#include "InputLog.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+
+const int TILE_SIZE = 40;
+const int TILES_WIDTH = 30;
+const int TILES_HEIGHT = 20;
+const float FRAME_TIME = 1.0f / 60.0f;
+const float INPUT_CHANGE_PROBABILITY = 0.05f;
+
+struct GameResult
+{
+  int bombsSurvived;
+  float survivalTime;
+  bool timedOut;
+};
+
+struct SimOptions
+{
+  int games = 1000;
+  std::uint64_t seed = 1;
+  float maxGameTime = 300.0f;
+  BlastZoneBackend backend = BlastZoneBackend::EDGE_MAP;
+  float blastRadius = Bomb::BLAST_RADIUS;
+  std::string replayPath;
+};
+
+bool parseOptions(int argc, char** argv, SimOptions& options);
+bool parseBackend(const std::string& name, BlastZoneBackend& backend);
+GameResult runGame(std::uint64_t seed, const SimOptions& options);
+PlayerInput randomInput(RandomStream& random);
+int runReplay(const SimOptions& options);
+void printStats(const SimOptions& options, std::vector<GameResult>& results, double wallSeconds);
+
+int main(int argc, char** argv)
+{
+  SimOptions options;
+  if (!parseOptions(argc, argv, options))
+  {
+    std::cerr << "Usage: blastzone_sim [--games N] [--seed S] [--max-time SECONDS] [--backend edge|grid|sweep] [--blast-radius R] [--replay FILE]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!options.replayPath.empty())
+    return runReplay(options);
+
+  std::vector<GameResult> results(options.games);
+  auto start = std::chrono::steady_clock::now();
+
+  #pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < options.games; i++)
+    results[i] = runGame(options.seed + i, options);
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  printStats(options, results, elapsed.count());
+  return 0;
+}
+
+bool parseOptions(int argc, char** argv, SimOptions& options)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    std::string argument = argv[i];
+    if (i + 1 >= argc)
+      return false;
+    if (argument == "--games")
+      options.games = std::atoi(argv[++i]);
+    else if (argument == "--seed")
+      options.seed = std::strtoull(argv[++i], nullptr, 10);
+    else if (argument == "--max-time")
+      options.maxGameTime = std::atof(argv[++i]);
+    else if (argument == "--replay")
+      options.replayPath = argv[++i];
+    else if (argument == "--blast-radius")
+      options.blastRadius = std::atof(argv[++i]);
+    else if (argument == "--backend")
+    {
+      if (!parseBackend(argv[++i], options.backend))
+        return false;
+    }
+    else
+      return false;
+  }
+  return options.games > 0 && options.maxGameTime > 0.0f && options.blastRadius > 0.0f;
+}
+
+bool parseBackend(const std::string& name, BlastZoneBackend& backend)
+{
+  if (name == "edge")
+    backend = BlastZoneBackend::EDGE_MAP;
+  else if (name == "grid")
+    backend = BlastZoneBackend::TILE_GRID;
+  else if (name == "sweep")
+    backend = BlastZoneBackend::ANGULAR_SWEEP;
+  else
+    return false;
+  return true;
+}
+
+GameResult runGame(std::uint64_t seed, const SimOptions& options)
+{
+  RandomService random(seed);
+  Simulation simulation(TILES_WIDTH, TILES_HEIGHT, TILE_SIZE, random);
+  simulation.setBlastZoneBackend(options.backend);
+  simulation.setBlastRadius(options.blastRadius);
+  RandomStream inputRandom = random.getStream("bot");
+  PlayerInput input = randomInput(inputRandom);
+
+  while (!simulation.isGameLost() && simulation.getSurvivalTime() < options.maxGameTime)
+  {
+    if (inputRandom.nextFloat() < INPUT_CHANGE_PROBABILITY)
+      input = randomInput(inputRandom);
+    simulation.step(input, FRAME_TIME);
+  }
+
+  if (simulation.isGameLost())
+    return { simulation.getBombsSurvived(), simulation.getSurvivalTime(), false };
+  else
+    return { simulation.getLevel().getBombDetonatedCount(), simulation.getSurvivalTime(), true };
+}
+
+PlayerInput randomInput(RandomStream& random)
+{
+  int mask = random.nextInt(16);
+  return { (mask & 1) != 0, (mask & 2) != 0, (mask & 4) != 0, (mask & 8) != 0 };
+}
+
+int runReplay(const SimOptions& options)
+{
+  InputLog replay;
+  if (!replay.load(options.replayPath))
+  {
+    std::cerr << "Could not read replay " << options.replayPath << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  RandomService random(replay.getSeed());
+  Simulation simulation(replay.getNumberOfTilesWidth(), replay.getNumberOfTilesHeight(), replay.getTileSize(), random);
+  simulation.setBlastZoneBackend(options.backend);
+  simulation.setBlastRadius(options.blastRadius);
+
+  double simulatedTime = 0.0;
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t frame = 0; frame < replay.getFrameCount(); frame++)
+  {
+    if (replay.isRestart(frame))
+      simulation.reset();
+    simulation.step(replay.getInput(frame), replay.getFrameTime(frame));
+    simulatedTime += replay.getFrameTime(frame);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  const Player& player = simulation.getPlayer();
+  const InputLog::FinalState& recorded = replay.getFinalState();
+  bool matches = player.getPositionX() == recorded.playerX && player.getPositionY() == recorded.playerY
+    && simulation.getLevel().getBombSpawnCount() == recorded.bombsSpawned;
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "replay:                " << options.replayPath << " (seed " << replay.getSeed() << ")" << std::endl;
+  std::cout << "frames:                " << replay.getFrameCount() << std::endl;
+  std::cout << "wall time:             " << elapsed.count() << " s" << std::endl;
+  std::cout << "simulated speed-up:    " << simulatedTime / elapsed.count() << "x" << std::endl;
+  std::cout << "bombs spawned:         " << simulation.getLevel().getBombSpawnCount() << std::endl;
+  std::cout << "matches recording:     " << (matches ? "yes" : "no") << std::endl;
+  return matches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+void printStats(const SimOptions& options, std::vector<GameResult>& results, double wallSeconds)
+{
+  std::sort(results.begin(), results.end(), [](const GameResult& r1, const GameResult& r2)
+  {
+    return r1.bombsSurvived < r2.bombsSurvived;
+  });
+
+  double totalSimulatedTime = 0.0;
+  double totalBombsSurvived = 0.0;
+  int timedOutGames = 0;
+  for (const GameResult& result : results)
+  {
+    totalSimulatedTime += result.survivalTime;
+    totalBombsSurvived += result.bombsSurvived;
+    if (result.timedOut)
+      timedOutGames++;
+  }
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "games:                 " << results.size() << " (seeds " << options.seed << ".." << options.seed + results.size() - 1 << ")" << std::endl;
+  std::cout << "wall time:             " << wallSeconds << " s" << std::endl;
+  std::cout << "games per second:      " << results.size() / wallSeconds << std::endl;
+  std::cout << "simulated speed-up:    " << totalSimulatedTime / wallSeconds << "x" << std::endl;
+  std::cout << "mean bombs survived:   " << totalBombsSurvived / results.size() << std::endl;
+  std::cout << "median bombs survived: " << results[results.size() / 2].bombsSurvived << std::endl;
+  std::cout << "max bombs survived:    " << results.back().bombsSurvived << std::endl;
+  std::cout << "mean survival time:    " << totalSimulatedTime / results.size() << " s" << std::endl;
+  std::cout << "survived to time cap:  " << timedOutGames << " (" << 100.0 * timedOutGames / results.size() << "%)" << std::endl;
+}
\ No newline at end of file